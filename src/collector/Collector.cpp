@@ -3,6 +3,7 @@
 
 #include <QDir>
 #include <QUrl>
+#include <QElapsedTimer>
 #include <QSettings>
 #include <QHostInfo>
 #include <QStandardPaths>
@@ -15,6 +16,7 @@
 #include "Collector.h"
 #include "Logging.h"
 #include "SharedTypes.h"
+#include "Trace.h"
 
 #define dumpvar(x) qDebug()<<#x<<'='<<x
 
@@ -28,6 +30,12 @@ Collector::Collector(int argc, char *argv[])
 
     m_start_time = QDateTime::currentDateTime();
 
+    // Instruments must exist before anything in the pipeline runs
+    initialize_metrics();
+
+    // With tracing built in, SIGUSR1 dumps the trace rings to the temp folder
+    TRACE_INSTALL_DUMP_SIGNAL(QDir::tempPath(), this);
+
     m_name = QHostInfo().localHostName();
 
     // Generate our settings file path/name
@@ -42,6 +50,8 @@ Collector::Collector(int argc, char *argv[])
 
     // Install a log message handler in case the user wants to capture
     // output to a file.
+    // Until a log directory is known, the writer goes to the console.
+    m_log = LogWriterPtr(new LogWriter(QString(), LogWriter::Rotation()));
     originalHandler = qInstallMessageHandler(logHandler);
     Q_UNUSED(originalHandler)
 
@@ -84,6 +94,47 @@ Collector::Collector(int argc, char *argv[])
     logFileOption.setDefaultValue("");
     parser.addOption(logFileOption);
 
+    QCommandLineOption logLevelOption(QStringList() << "log-level",
+            QCoreApplication::translate("main", "Least severe messages to log (debug, info, warning or critical)."),
+            QCoreApplication::translate("main", "LEVEL"));
+    logLevelOption.setDefaultValue(m_log_level);
+    parser.addOption(logLevelOption);
+
+    QCommandLineOption logMaxSizeOption(QStringList() << "log-max-size",
+            QCoreApplication::translate("main", "Rotate the log file once it grows past <size> megabytes (0 = never)."),
+            QCoreApplication::translate("main", "MB"));
+    logMaxSizeOption.setDefaultValue("10");
+    parser.addOption(logMaxSizeOption);
+
+    QCommandLineOption logRotateHoursOption(QStringList() << "log-rotate-hours",
+            QCoreApplication::translate("main", "Rotate the log file after it has been open for <hours> (0 = never)."),
+            QCoreApplication::translate("main", "HOURS"));
+    logRotateHoursOption.setDefaultValue("0");
+    parser.addOption(logRotateHoursOption);
+
+    QCommandLineOption logKeepOption(QStringList() << "log-keep",
+            QCoreApplication::translate("main", "Number of rotated log files to keep."),
+            QCoreApplication::translate("main", "COUNT"));
+    logKeepOption.setDefaultValue("5");
+    parser.addOption(logKeepOption);
+
+    QCommandLineOption journalOption(QStringList() << "j" << "journal",
+            QCoreApplication::translate("main", "Record every Sensor state transition in a journal under <directory>."),
+            QCoreApplication::translate("main", "DIR"));
+    parser.addOption(journalOption);
+
+    QCommandLineOption journalSegmentRecordsOption(QStringList() << "journal-segment-records",
+            QCoreApplication::translate("main", "Transitions held by each new journal segment file."),
+            QCoreApplication::translate("main", "COUNT"));
+    journalSegmentRecordsOption.setDefaultValue(QString::number(Journal::default_segment_records));
+    parser.addOption(journalSegmentRecordsOption);
+
+    QCommandLineOption journalSegmentsOption(QStringList() << "journal-segments",
+            QCoreApplication::translate("main", "Journal segment files kept before the oldest is removed (0 = keep all)."),
+            QCoreApplication::translate("main", "COUNT"));
+    journalSegmentsOption.setDefaultValue("64");
+    parser.addOption(journalSegmentsOption);
+
     QCommandLineOption portOption(QStringList() << "P" << "port",
                                   QCoreApplication::translate("main", "Multicast port"),
                                   QCoreApplication::translate("main", "PORT"));
@@ -102,10 +153,164 @@ Collector::Collector(int argc, char *argv[])
     ip4Option.setDefaultValue(m_ip6_group);
     parser.addOption(ip6Option);
 
+    QCommandLineOption priorityGroupOption(QStringList() << "priority-group",
+            QCoreApplication::translate("main", "Also send Critical and Deceased transitions to this multicast group, ahead of routine traffic."),
+            QCoreApplication::translate("main", "ADDRESS"));
+    parser.addOption(priorityGroupOption);
+
+    QCommandLineOption priorityPortOption(QStringList() << "priority-port",
+            QCoreApplication::translate("main", "Port for the priority group (default: the multicast port plus one)."),
+            QCoreApplication::translate("main", "PORT"));
+    parser.addOption(priorityPortOption);
+
+    QCommandLineOption priorityDscpOption(QStringList() << "priority-dscp",
+            QCoreApplication::translate("main", "DSCP to mark priority datagrams with (46 is Expedited Forwarding)."),
+            QCoreApplication::translate("main", "DSCP"));
+    priorityDscpOption.setDefaultValue("46");
+    parser.addOption(priorityDscpOption);
+
+    QCommandLineOption topicOption(QStringList() << "topic",
+            QCoreApplication::translate("main", "Publish to the multicast group derived from <topic> (e.g., a tenant name) instead of --ipv4/--ipv6."),
+            QCoreApplication::translate("main", "TOPIC"));
+    parser.addOption(topicOption);
+
     // QCommandLineOption cleanOption(QStringList() << "clean-on-startup",
     //         QCoreApplication::translate("main", "Clear all existing sensor-data files on startup."));
     // parser.addOption(cleanOption);
 
+#ifdef QT_LINUX
+    QCommandLineOption socketOption(QStringList() << "s" << "socket",
+            QCoreApplication::translate("main", "Also accept Sensor reports on the Unix datagram socket at <path>."),
+            QCoreApplication::translate("main", "PATH"));
+    socketOption.setDefaultValue(m_socket_path);
+    parser.addOption(socketOption);
+
+    QCommandLineOption socketRateOption(QStringList() << "socket-rate",
+            QCoreApplication::translate("main", "Maximum Sensor reports per second accepted from each process on the local socket."),
+            QCoreApplication::translate("main", "COUNT"));
+    socketRateOption.setDefaultValue("20");
+    parser.addOption(socketRateOption);
+
+    QCommandLineOption shmOption(QStringList() << "shm",
+            QCoreApplication::translate("main", "Publish a shared-memory Sensor slot table under <name> (e.g., /dash-d)."),
+            QCoreApplication::translate("main", "NAME"));
+    shmOption.setDefaultValue(m_shm_name);
+    parser.addOption(shmOption);
+
+    QCommandLineOption shmSlotsOption(QStringList() << "shm-slots",
+            QCoreApplication::translate("main", "Number of Sensor slots in the shared-memory table."),
+            QCoreApplication::translate("main", "COUNT"));
+    shmSlotsOption.setDefaultValue("256");
+    parser.addOption(shmSlotsOption);
+
+    QCommandLineOption shmIntervalOption(QStringList() << "shm-interval",
+            QCoreApplication::translate("main", "Milliseconds between scans of the shared-memory table."),
+            QCoreApplication::translate("main", "MSECS"));
+    shmIntervalOption.setDefaultValue("20");
+    parser.addOption(shmIntervalOption);
+#endif
+
+    QCommandLineOption sendRateOption(QStringList() << "send-rate",
+            QCoreApplication::translate("main", "Maximum datagrams per second sent to the multicast group."),
+            QCoreApplication::translate("main", "COUNT"));
+    sendRateOption.setDefaultValue("2000");
+    parser.addOption(sendRateOption);
+
+    QCommandLineOption compressOption(QStringList() << "compress",
+            QCoreApplication::translate("main", "Compress datagrams, and fragment any larger than the MTU (every Dashboard on the ring must support this)."));
+    parser.addOption(compressOption);
+
+    QCommandLineOption mtuOption(QStringList() << "mtu",
+            QCoreApplication::translate("main", "Largest datagram to send when --compress is enabled."),
+            QCoreApplication::translate("main", "BYTES"));
+    mtuOption.setDefaultValue(QString::number(Codec::default_mtu));
+    parser.addOption(mtuOption);
+
+    QCommandLineOption ttlOption(QStringList() << "ttl",
+            QCoreApplication::translate("main", "Router hops our multicast datagrams may cross (1 keeps them in this subnet)."),
+            QCoreApplication::translate("main", "HOPS"));
+    ttlOption.setDefaultValue("1");
+    parser.addOption(ttlOption);
+
+    QCommandLineOption relayFromOption(QStringList() << "relay-from",
+            QCoreApplication::translate("main", "Relay the multicast ring at <address> to our group instead of watching a queue."),
+            QCoreApplication::translate("main", "ADDRESS"));
+    parser.addOption(relayFromOption);
+
+    QCommandLineOption relayPortOption(QStringList() << "relay-port",
+            QCoreApplication::translate("main", "Port of the ring being relayed (default: the multicast port)."),
+            QCoreApplication::translate("main", "PORT"));
+    parser.addOption(relayPortOption);
+
+    QCommandLineOption relayDomainRateOption(QStringList() << "relay-domain-rate",
+            QCoreApplication::translate("main", "Maximum reports per second relayed for each Domain."),
+            QCoreApplication::translate("main", "COUNT"));
+    relayDomainRateOption.setDefaultValue("20");
+    parser.addOption(relayDomainRateOption);
+
+    QCommandLineOption relayMaxSensorsOption(QStringList() << "relay-max-sensors",
+            QCoreApplication::translate("main", "Most Sensors a relay remembers for initializing Dashboards."),
+            QCoreApplication::translate("main", "COUNT"));
+    relayMaxSensorsOption.setDefaultValue("250000");
+    parser.addOption(relayMaxSensorsOption);
+
+    QCommandLineOption metricsPortOption(QStringList() << "metrics-port",
+            QCoreApplication::translate("main", "Serve Prometheus metrics over HTTP on <port> (0 = disabled)."),
+            QCoreApplication::translate("main", "PORT"));
+    metricsPortOption.setDefaultValue("0");
+    parser.addOption(metricsPortOption);
+
+    QCommandLineOption metricsAddressOption(QStringList() << "metrics-address",
+            QCoreApplication::translate("main", "Address the metrics endpoint listens on."),
+            QCoreApplication::translate("main", "ADDRESS"));
+    metricsAddressOption.setDefaultValue("127.0.0.1");
+    parser.addOption(metricsAddressOption);
+
+    QCommandLineOption metricsFileOption(QStringList() << "metrics-file",
+            QCoreApplication::translate("main", "Periodically write Prometheus metrics to <file> (for a textfile collector)."),
+            QCoreApplication::translate("main", "FILE"));
+    parser.addOption(metricsFileOption);
+
+    QCommandLineOption metricsIntervalOption(QStringList() << "metrics-interval",
+            QCoreApplication::translate("main", "Seconds between rewrites of the metrics file."),
+            QCoreApplication::translate("main", "SECONDS"));
+    metricsIntervalOption.setDefaultValue("15");
+    parser.addOption(metricsIntervalOption);
+
+    QCommandLineOption dampConfirmOption(QStringList() << "damp-confirm",
+            QCoreApplication::translate("main", "Publish a Sensor's new state only once seen in N of its last M reports."),
+            QCoreApplication::translate("main", "N/M"));
+    dampConfirmOption.setDefaultValue("1/1");
+    parser.addOption(dampConfirmOption);
+
+    QCommandLineOption dampDwellOption(QStringList() << "damp-dwell",
+            QCoreApplication::translate("main", "Publish a Sensor's new state only once it has lasted <msecs>."),
+            QCoreApplication::translate("main", "MSECS"));
+    dampDwellOption.setDefaultValue("0");
+    parser.addOption(dampDwellOption);
+
+    QCommandLineOption dampHalfLifeOption(QStringList() << "damp-half-life",
+            QCoreApplication::translate("main", "Suppress flapping Sensors, with flap penalties halving every <seconds> (0 = never suppress)."),
+            QCoreApplication::translate("main", "SECONDS"));
+    dampHalfLifeOption.setDefaultValue("0");
+    parser.addOption(dampHalfLifeOption);
+
+    QCommandLineOption dampSuppressOption(QStringList() << "damp-suppress",
+            QCoreApplication::translate("main", "Flaps (each adding a penalty of 1) after which a Sensor is suppressed."),
+            QCoreApplication::translate("main", "FLAPS"));
+    dampSuppressOption.setDefaultValue("2");
+    parser.addOption(dampSuppressOption);
+
+    QCommandLineOption dampReuseOption(QStringList() << "damp-reuse",
+            QCoreApplication::translate("main", "Penalty a suppressed Sensor must decay below to be published again."),
+            QCoreApplication::translate("main", "FLAPS"));
+    dampReuseOption.setDefaultValue("0.75");
+    parser.addOption(dampReuseOption);
+
+    QCommandLineOption legacyOfflineOption(QStringList() << "legacy-offline",
+            QCoreApplication::translate("main", "On shutdown, flag each Sensor offline separately (for Dashboards that predate Domain offline notices)."));
+    parser.addOption(legacyOfflineOption);
+
     QCommandLineOption detectOffline(QStringList() << "detect-offline",
             QCoreApplication::translate("main", "Heuristically attempt to detect that a Sensor has gone offline."));
     parser.addOption(detectOffline);
@@ -117,14 +322,41 @@ Collector::Collector(int argc, char *argv[])
     parser.process(*this);
 
     m_detect_offline = parser.isSet(detectOffline);
+    m_legacy_offline = parser.isSet(legacyOfflineOption);
+
+    // Flap damping has to be in place before the first report is processed
+    FlapDamper::Settings damping;
+    auto confirm = parser.value(dampConfirmOption).split('/');
+    damping.confirm = confirm.value(0).toInt();
+    damping.window = confirm.value(1, confirm.value(0)).toInt();
+    damping.dwell = parser.value(dampDwellOption).toLongLong();
+    damping.half_life = parser.value(dampHalfLifeOption).toInt();
+    damping.suppress = parser.value(dampSuppressOption).toDouble() * damping.penalty;
+    damping.reuse = parser.value(dampReuseOption).toDouble() * damping.penalty;
+    damping.max_penalty = qMax(damping.max_penalty, damping.suppress * 2);
+    if(damping.window > 1 || damping.dwell > 0 || damping.half_life > 0)
+    {
+        m_damper = FlapDamperPtr(new FlapDamper(damping));
+        damping = m_damper->settings();
+
+        m_damping_timer = TimerPtr(new QTimer());
+        m_damping_timer->setInterval(damping_interval);
+        connect(m_damping_timer.data(), &QTimer::timeout, this, &Collector::slot_release_damped);
+        m_damping_timer->start();
+    }
 
     if(parser.isSet(updateOption))
     {
         m_queue_path = parser.value(targetDirectoryOption);
         m_log_path = parser.value(logFileOption);
+        m_log_level = parser.value(logLevelOption);
         m_ip4_group = parser.value(ip4Option);
         m_ip6_group = parser.value(ip6Option);
         m_port = parser.value(portOption).toUShort();
+#ifdef QT_LINUX
+        m_socket_path = parser.value(socketOption);
+        m_shm_name = parser.value(shmOption);
+#endif
 
         save_settings();
 
@@ -132,15 +364,27 @@ Collector::Collector(int argc, char *argv[])
     }
 
     // Initialization steps:
-    // 1. Set up logging output (console or log file)
+    // 1. Set up logging output (console or log file), and the journal (if requested)
     // 2. Create a Watcher for the file system
     // 3. Create Sender instance for IPv4 or IPv6
+    // 4. Open the local socket for Sensors that push their reports (if requested)
+    // 5. Publish the shared-memory slot table (if requested)
+    // 6. Relay another multicast ring (if requested; replaces step 2)
+    // 7. Publish metrics (if requested)
 
-    // ----- 1. Set up logging output (console or log file)
+    const auto relay_from = parser.value(relayFromOption);
+
+    // ----- 1. Set up logging output (console or log file), and the journal (if requested)
 
     // FYI: This needs to be initialized first, so logging macros
     // can properly redirect (if required)
 
+    QtMsgType log_level{QtInfoMsg};
+    if(LogWriter::parse_level(parser.value(logLevelOption), log_level))
+        m_log->set_level(log_level);
+    else
+        qWarning() << tr("Unknown log level \"") << parser.value(logLevelOption) << tr("\"; using \"info\".");
+
     auto target_path = parser.value(logFileOption);
     if(!target_path.isEmpty())
     {
@@ -156,14 +400,23 @@ Collector::Collector(int argc, char *argv[])
             }
         }
 
+        LogWriter::Rotation rotation;
+        rotation.max_size = parser.value(logMaxSizeOption).toLongLong() * 1024 * 1024;
+        rotation.max_age = parser.value(logRotateHoursOption).toInt();
+        rotation.keep = qMax(0, parser.value(logKeepOption).toInt());
+
         auto log_file_name = QString("%1/dash-d.log").arg(target_path);
-        m_log = FilePtr(new QFile(log_file_name));
-        if(!m_log->open(QIODevice::WriteOnly | QIODevice::Append))
+        LogWriterPtr log(new LogWriter(log_file_name, rotation));
+        if(!log->is_open())
         {
             qCritical() << tr("Could not create/open log file \"") << log_file_name<< "\".";
             qApp->exit(1);
             return;
         }
+
+        log->set_level(log_level);
+        m_log->flush();
+        m_log = log;
     }
 
     setLog_path(target_path);
@@ -171,40 +424,72 @@ Collector::Collector(int argc, char *argv[])
     qInfo() << tr("─────────────────────────────┤ Start ├─────────────────────────────");
     qInfo() << applicationName() << " v" << applicationVersion();
 
-    if(m_log.isNull())
+    if(m_log->path().isEmpty())
         qInfo() << tr("Logging output to console.");
     else
-        qInfo() << tr("Logging output to \"") << m_log->fileName() << "\".";
+        qInfo() << tr("Logging output to \"") << m_log->path() << "\".";
 
-    // ----- 2. Create a Watcher for the file system
-    target_path = parser.value(targetDirectoryOption);
-    QDir p(target_path);
-    if(!p.exists())
+    // The watcher reports existing Sensors as it starts, so the journal
+    // must be ready before it is
+    auto journal_path = parser.value(journalOption);
+    if(!journal_path.isEmpty())
     {
-        // Ensure the full path exists
-        if(!p.mkpath("."))
+        m_journal = JournalPtr(new Journal(journal_path,
+                                           parser.value(journalSegmentRecordsOption).toUInt(),
+                                           parser.value(journalSegmentsOption).toInt()));
+        if(m_journal->open())
+            qInfo() << tr("Journaling Sensor state transitions to \"") << journal_path << "\" ("
+                    << m_journal->records() << tr(" transitions in ") << m_journal->segments() << tr(" segments).");
+        else
         {
-            qCritical() << tr("Could not create queue directory \"") << target_path << "\".";
-            qApp->exit(1);
-            return;
+            qWarning() << tr("Could not open the journal: ") << m_journal->error_string();
+            m_journal.clear();
         }
     }
 
-    setQueue_path(target_path);
+    // ----- 2. Create a Watcher for the file system
+    if(relay_from.isEmpty())
+    {
+        target_path = parser.value(targetDirectoryOption);
+        QDir p(target_path);
+        if(!p.exists())
+        {
+            // Ensure the full path exists
+            if(!p.mkpath("."))
+            {
+                qCritical() << tr("Could not create queue directory \"") << target_path << "\".";
+                qApp->exit(1);
+                return;
+            }
+        }
+
+        setQueue_path(target_path);
 
-    m_watcher = WatcherPtr(new QFileSystemWatcher());
-    connect(m_watcher.data(), &QFileSystemWatcher::directoryChanged, this, &Collector::slot_directory_event);
-    connect(m_watcher.data(), &QFileSystemWatcher::fileChanged, this, &Collector::slot_file_event);
+        m_watcher = WatcherPtr(new QFileSystemWatcher());
+        connect(m_watcher.data(), &QFileSystemWatcher::directoryChanged, this, &Collector::slot_directory_event);
+        connect(m_watcher.data(), &QFileSystemWatcher::fileChanged, this, &Collector::slot_file_event);
 
-    initialize_watcher();
+        initialize_watcher();
 
-    qInfo() << tr("Watching queue location \"") << target_path << "\".";
+        qInfo() << tr("Watching queue location \"") << target_path << "\".";
+    }
 
     // ----- 3. Create Sender instance for IPv4 or IPv6
     auto port = parser.value(portOption).toUShort();
     QString ip4group = parser.value(ip4Option);
     QString ip6group = parser.value(ip6Option);
 
+    if(parser.isSet(topicOption))
+    {
+        // Dashboards on other topics never join this group, so never receive our traffic
+        auto topic = parser.value(topicOption);
+        if(ip6group.isEmpty())
+            ip4group = SharedTypes::topic_group_ipv4(topic);
+        else
+            ip6group = SharedTypes::topic_group_ipv6(topic);
+        qInfo() << tr("Publishing topic \"") << topic << tr("\" to ") << (ip6group.isEmpty() ? ip4group : ip6group) << ".";
+    }
+
     if(!ip4group.isEmpty() && !ip6group.isEmpty())
     {
         // This is an error
@@ -224,6 +509,42 @@ Collector::Collector(int argc, char *argv[])
 
     // Create sender connection to the group
     m_multicast_sender = SenderPtr(new Sender(port, ip4group, ip6group));
+    auto send_rate = qMax(1, parser.value(sendRateOption).toInt());
+    // Allow a rebroadcast of a typical cache to go out in one pass
+    m_multicast_sender->set_rate(send_rate, qMax(send_rate / 8, 64));
+    // Our reports (and rebroadcasts of them) go out stamped with when they
+    // left; a relay forwards the source ring's stamps untouched
+    m_multicast_sender->set_stamp_sent(relay_from.isEmpty());
+    if(parser.isSet(compressOption))
+    {
+        auto mtu = qMax(Codec::header_size + 64, parser.value(mtuOption).toInt());
+        m_multicast_sender->set_compression(true, mtu);
+        qInfo() << tr("Compressing datagrams (MTU ") << mtu << ").";
+    }
+    auto ttl = parser.value(ttlOption).toInt();
+    if(ttl > 1)
+    {
+        m_multicast_sender->set_ttl(ttl);
+        qInfo() << tr("Multicast datagrams may cross ") << ttl << tr(" router hops.");
+    }
+    if(parser.isSet(priorityGroupOption))
+    {
+        // Its own port, since a socket bound to a port hears every group
+        // joined on it; and its own queue and pacer, so alerts never wait
+        // behind a rebroadcast
+        auto priority_group = parser.value(priorityGroupOption);
+        auto priority_port = parser.isSet(priorityPortOption) ? parser.value(priorityPortOption).toUShort() : static_cast<quint16>(port + 1);
+        m_priority_sender = SenderPtr(new Sender(priority_port, priority_group, priority_group));
+        m_priority_sender->set_dscp(parser.value(priorityDscpOption).toInt());
+        m_priority_sender->set_stamp_sent(true);
+        if(parser.isSet(compressOption))
+            m_priority_sender->set_compression(true, qMax(Codec::header_size + 64, parser.value(mtuOption).toInt()));
+        if(ttl > 1)
+            m_priority_sender->set_ttl(ttl);
+        qInfo() << tr("Sending Critical and Deceased transitions to priority group ") << priority_group << ":" << priority_port
+                << tr(" (DSCP ") << parser.value(priorityDscpOption).toInt() << ").";
+    }
+
     m_multicast_receiver.reset(new Receiver(port, ip4group, ip6group, this));
     connect(m_multicast_receiver.data(), &Receiver::signal_datagram_available, this, &Collector::slot_process_peer_event);
 
@@ -238,11 +559,110 @@ Collector::Collector(int argc, char *argv[])
     else
         qInfo() << tr("Not detecting offline Sensors.");
 
+    if(m_damper)
+        qInfo() << tr("Damping Sensor state changes: ") << damping.confirm << "/" << damping.window
+                << tr(" confirmation, ") << damping.dwell << tr(" ms dwell, ")
+                << (damping.half_life ? tr("%1 s penalty half-life").arg(damping.half_life) : tr("no flap suppression")) << ".";
+
     if(!ip4group.isEmpty())
         qInfo() << tr("Sending sensor data to IPv4 multicast ") << qUtf8Printable(ip4group) << ":" << port << ".";
     else
         qInfo() << tr("Sending sensor data to IPv6 multicast ") << ip6group << ":" << port << ".";
 
+    // ----- 4. Open the local socket for Sensors that push their reports (if requested)
+#ifdef QT_LINUX
+    auto socket_path = parser.value(socketOption);
+    if(!socket_path.isEmpty())
+    {
+        m_local_receiver = LocalReceiverPtr(new LocalReceiver(socket_path));
+        if(m_local_receiver->is_listening())
+        {
+            auto rate = parser.value(socketRateOption).toInt();
+            m_local_receiver->set_rate_limit(rate, rate * 2);
+            connect(m_local_receiver.data(), &LocalReceiver::signal_report_available, this, &Collector::slot_local_report);
+            qInfo() << tr("Accepting Sensor reports on local socket \"") << socket_path << "\".";
+        }
+        else
+            m_local_receiver.clear();
+    }
+
+    // ----- 5. Publish the shared-memory slot table (if requested)
+    auto shm_name = parser.value(shmOption);
+    if(!shm_name.isEmpty())
+    {
+        auto slot_count = qBound(1u, parser.value(shmSlotsOption).toUInt(), DASHD_SHM_MAX_SLOTS);
+        auto interval = qMax(1, parser.value(shmIntervalOption).toInt());
+
+        m_slot_table = SlotTablePtr(new SlotTable(shm_name, slot_count, interval));
+        if(m_slot_table->is_open())
+        {
+            connect(m_slot_table.data(), &SlotTable::signal_slot_changed, this, &Collector::slot_shm_changed);
+            qInfo() << tr("Publishing ") << slot_count << tr(" shared-memory Sensor slots as \"") << shm_name << "\".";
+        }
+        else
+            m_slot_table.clear();
+    }
+#endif
+
+    // ----- 6. Relay another multicast ring (if requested; replaces step 2)
+    if(!relay_from.isEmpty())
+    {
+        QHostAddress source(relay_from);
+        if(source.isNull())
+        {
+            qCritical() << tr("Invalid relay address \"") << relay_from << "\".";
+            qApp->exit(1);
+            return;
+        }
+
+        // Receivers hear only the groups they join, so the source ring may
+        // share our port; it must not BE our ring, or the relay would
+        // forward its own output
+        auto relay_port = parser.isSet(relayPortOption) ? parser.value(relayPortOption).toUShort() : port;
+        if(relay_port == port && (source == QHostAddress(ip4group) || source == QHostAddress(ip6group)))
+        {
+            qCritical() << tr("The relayed ring must not be our own group (") << relay_from << ":" << port << ").";
+            qApp->exit(1);
+            return;
+        }
+
+        if(source.protocol() == QAbstractSocket::IPv4Protocol)
+            m_relay_receiver.reset(new Receiver(relay_port, relay_from, QString(), this));
+        else
+            m_relay_receiver.reset(new Receiver(relay_port, QString(), relay_from, this));
+
+        auto domain_rate = qMax(1, parser.value(relayDomainRateOption).toInt());
+        m_relay = RelayPtr(new Relay(m_relay_receiver, m_multicast_sender));
+        m_relay->set_domain_rate(domain_rate, domain_rate * 5);
+        m_relay->set_max_sensors(parser.value(relayMaxSensorsOption).toInt());
+        m_relay->request_initialize(SenderPtr(new Sender(relay_port, relay_from, relay_from)));
+
+        qInfo() << tr("Relaying multicast ") << relay_from << ":" << relay_port << tr(" to our group.");
+    }
+
+    // ----- 7. Publish metrics (if requested)
+    auto metrics_port = parser.value(metricsPortOption).toUShort();
+    auto metrics_file = parser.value(metricsFileOption);
+    if(metrics_port || !metrics_file.isEmpty())
+    {
+        m_metrics_server = MetricsServerPtr(new MetricsServer(m_metrics));
+
+        if(metrics_port)
+        {
+            QHostAddress address(parser.value(metricsAddressOption));
+            if(m_metrics_server->listen(address, metrics_port))
+                qInfo() << tr("Serving metrics on http://") << address.toString() << ":" << metrics_port << "/metrics.";
+            else
+                qWarning() << tr("Could not serve metrics on port ") << metrics_port << ": " << m_metrics_server->error_string();
+        }
+
+        if(!metrics_file.isEmpty())
+        {
+            m_metrics_server->set_textfile(metrics_file, parser.value(metricsIntervalOption).toInt());
+            qInfo() << tr("Writing metrics to \"") << metrics_file << "\".";
+        }
+    }
+
     QTimer::singleShot(0, this, &Collector::slot_broadcast_cached_events);
 }
 
@@ -254,9 +674,46 @@ Collector::~Collector()
 
     qInfo() << tr("Shutting down.");
 
-    auto keys = m_queue_cache.keys();
-    foreach(QString key, keys)
-        process_sensor_offline(key, tr("Collector shutting down; flagging offline."));
+    if(m_legacy_offline)
+    {
+        auto keys = m_queue_cache.keys();
+        foreach(QString key, keys)
+            process_sensor_offline(key, tr("Collector shutting down; flagging offline."));
+    }
+    else
+        process_domain_offline(tr("Collector shutting down; flagging all Sensors offline."));
+
+    if(m_damper)
+        qInfo() << tr("Sensor state changes held: ") << m_damper->held()
+                << tr(", released: ") << m_damper->released()
+                << tr(", discarded: ") << m_damper->discarded();
+
+    if(m_relay)
+        qInfo() << tr("Relayed reports received: ") << m_relay->received()
+                << tr(", forwarded: ") << m_relay->forwarded()
+                << tr(", coalesced: ") << m_relay->coalesced()
+                << tr(", duplicates: ") << m_relay->duplicates()
+                << tr(", evicted: ") << m_relay->evicted();
+
+    if(m_multicast_sender)
+    {
+        // The event loop is gone, so the pacer will never run again
+        m_multicast_sender->flush();
+
+        qInfo() << tr("Datagrams queued: ") << m_multicast_sender->queued()
+                << tr(", sent: ") << m_multicast_sender->sent()
+                << tr(", dropped: ") << m_multicast_sender->dropped()
+                << tr(", errors: ") << m_multicast_sender->errors();
+    }
+
+    if(m_priority_sender)
+    {
+        m_priority_sender->flush();
+
+        qInfo() << tr("Priority datagrams sent: ") << m_priority_sender->sent()
+                << tr(", dropped: ") << m_priority_sender->dropped()
+                << tr(", errors: ") << m_priority_sender->errors();
+    }
 
     if(m_housekeeping)
     {
@@ -264,63 +721,111 @@ Collector::~Collector()
         m_housekeeping.clear();
     }
 
-    m_log.clear();
+    if(m_damping_timer)
+    {
+        m_damping_timer->stop();
+        m_damping_timer.clear();
+    }
+
     m_watcher.clear();
+    m_journal.clear();
+    m_damper.clear();
+#ifdef QT_LINUX
+    m_local_receiver.clear();
+    m_slot_table.clear();
+#endif
+    m_relay.clear();
+    m_relay_receiver.clear();
+    m_metrics_server.clear();
     m_multicast_sender.clear();
+    m_priority_sender.clear();
     m_multicast_receiver.clear();
+
+    // Last of all, so everything above makes it into the log.  Anything
+    // logged after this point is written directly to the console.
+    auto dropped = m_log->dropped();
+    if(dropped)
+        qWarning() << tr("Log messages dropped: ") << dropped;
+    m_log.clear();
 }
 
 // This is a callback used to intercept log message calls
 // so we can inject custom handling.
 void Collector::logHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg)
 {
-    QString message = qFormatLogMessage(type, context, msg);
-    collector->handle_log(type, message);
+    if(collector && !collector->m_log.isNull())
+    {
+        // Skip the formatting for anything below the current level
+        if(!collector->m_log->is_enabled(type) && type != QtFatalMsg)
+            return;
 
-    // not sure there's a point in calling this
-    if (originalHandler)
+        collector->handle_log(type, qFormatLogMessage(type, context, msg));
+    }
+    else if(originalHandler)
         originalHandler(type, context, msg);
 }
 
-// Redirect log messages to somewhere other than the console, if the user so desires.
+// Hand log messages to the writer thread, which sends them to the
+// console or to the log file, as the user desires.
 void Collector::handle_log(QtMsgType type, const QString &msg) const
 {
-    Q_UNUSED(msg)
+    m_log->write(type, msg);
 
-    static QMap<QtMsgType, QString> tags {
-        { QtDebugMsg, "Debug" },
-        { QtInfoMsg, "Info" },
-        { QtWarningMsg, "Warning" },
-        { QtCriticalMsg, "Critical" },
-        { QtFatalMsg, "Fatal" }
-    };
-
-    auto tag = tags[type];
-
-    if(m_log.isNull())
-    {
-        static QTextStream ts_stdout(stdout);
-        static QTextStream ts_stderr(stderr);
+    // Qt aborts once we return, so a fatal message must be on disk first
+    if(type == QtFatalMsg)
+        m_log->flush();
+}
 
-        switch(type)
-        {
-            case QtDebugMsg:
-            case QtInfoMsg:
-                ts_stdout << "[" << tag << "] " << QDateTime::currentDateTime().toString() << ": " << msg;
-                break;
-
-            case QtWarningMsg:
-            case QtCriticalMsg:
-            case QtFatalMsg:
-                ts_stderr << "[" << tag << "] " << QDateTime::currentDateTime().toString() << ": " << msg;
-                break;
-        }
-    }
-    else
-    {
-        QTextStream out(m_log.data());
-        out << "[" << tag << "] " << QDateTime::currentDateTime().toString() << ": " << msg << "\n";
-    }
+void Collector::initialize_metrics()
+{
+    m_metrics = MetricsPtr(new Metrics());
+    auto* m = m_metrics.data();
+
+    // watch event -> file read -> parse -> send
+    m_instruments.directory_events = m->add_counter("dashd_collector_directory_events_total", "Queue folder change notifications.");
+    m_instruments.file_events = m->add_counter("dashd_collector_file_events_total", "Sensor file change notifications.");
+    m_instruments.debounced_events = m->add_counter("dashd_collector_debounced_events_total", "Sensor file changes ignored as too soon after the last.");
+    m_instruments.read_seconds = m->add_histogram("dashd_collector_read_seconds", "Time to read a Sensor file.");
+    m_instruments.read_failures = m->add_counter("dashd_collector_read_failures_total", "Sensor files that could not be opened.");
+    m_instruments.parse_seconds = m->add_histogram("dashd_collector_parse_seconds", "Time to parse a Sensor report.");
+    m_instruments.parse_failures = m->add_counter("dashd_collector_parse_failures_total", "Sensor reports that were not valid JSON.");
+    m_instruments.invalid_states = m->add_counter("dashd_collector_invalid_states_total", "Sensor reports with an unknown state.");
+    m_instruments.reports = m->add_counter("dashd_collector_reports_total", "Sensor reports accepted and sent.");
+    m_instruments.send_seconds = m->add_histogram("dashd_collector_send_seconds", "Time to hand a report to the Sender.");
+    m_instruments.pipeline_seconds = m->add_histogram("dashd_collector_pipeline_seconds", "Time from a file event to its report being queued for sending.");
+
+    m_instruments.local_reports = m->add_counter("dashd_collector_local_reports_total", "Reports received on the local socket.");
+    m_instruments.shm_reports = m->add_counter("dashd_collector_shm_reports_total", "Changes picked up from the shared-memory slot table.");
+    m_instruments.offline_reports = m->add_counter("dashd_collector_offline_reports_total", "Offline notices sent for Sensors.");
+    m_instruments.offline_detections = m->add_counter("dashd_collector_offline_detections_total", "Sensors heuristically detected as offline.");
+    m_instruments.journal_records = m->add_counter("dashd_collector_journal_records_total", "Sensor state transitions written to the journal.");
+    m_instruments.priority_reports = m->add_counter("dashd_collector_priority_reports_total", "Critical and Deceased transitions also sent to the priority group.");
+    m->add_sampled_counter("dashd_collector_damped_total", "Sensor state changes held back by flap damping.",
+                           [this]() { return m_damper ? m_damper->held() : 0; });
+    m->add_sampled_counter("dashd_collector_damp_released_total", "Held state changes published once confirmed.",
+                           [this]() { return m_damper ? m_damper->released() : 0; });
+    m->add_sampled_counter("dashd_collector_damp_discarded_total", "Held state changes reverted before being published.",
+                           [this]() { return m_damper ? m_damper->discarded() : 0; });
+    m->add_gauge("dashd_collector_damp_holding", "Sensors with a state change currently held.",
+                 [this]() { return m_damper ? m_damper->holding() : 0; });
+    m->add_gauge("dashd_collector_damp_suppressed", "Sensors currently suppressed for flapping.",
+                 [this]() { return m_damper ? m_damper->suppressed() : 0; });
+    m_instruments.initialize_requests = m->add_counter("dashd_collector_initialize_requests_total", "Initialize requests received from Dashboards.");
+
+    m->add_gauge("dashd_collector_sensors", "Sensors currently cached.", [this]() { return m_queue_cache.count(); });
+    m->add_gauge("dashd_collector_uptime_seconds", "Seconds since the Collector started.",
+                 [this]() { return m_start_time.secsTo(QDateTime::currentDateTime()); });
+
+    m->add_sampled_counter("dashd_sender_queued_total", "Datagrams queued for sending.",
+                           [this]() { return m_multicast_sender ? m_multicast_sender->queued() : 0; });
+    m->add_sampled_counter("dashd_sender_sent_total", "Datagrams written to the network.",
+                           [this]() { return m_multicast_sender ? m_multicast_sender->sent() : 0; });
+    m->add_sampled_counter("dashd_sender_dropped_total", "Datagrams dropped from a full send queue.",
+                           [this]() { return m_multicast_sender ? m_multicast_sender->dropped() : 0; });
+    m->add_sampled_counter("dashd_sender_errors_total", "Datagrams the network refused.",
+                           [this]() { return m_multicast_sender ? m_multicast_sender->errors() : 0; });
+    m->add_gauge("dashd_sender_pending", "Datagrams waiting in the send queue.",
+                 [this]() { return m_multicast_sender ? m_multicast_sender->pending() : 0; });
 }
 
 void Collector::initialize_watcher()
@@ -366,96 +871,81 @@ void Collector::process_sensor_offline(const QString& file, const QString& msg)
     qWarning() << msg;
 
     auto sensor_name = m_queue_cache[file][0].toString();
-    auto sensor_offline = QString("{ \"domain_id\" : \"%1\", \"domain_name\" : \"%2\","
-                                " \"type\" : \"%3\","
-                                " \"sensor_name\" : \"%4\" }")
-        .arg(m_id)
-        .arg(QUrl::toPercentEncoding(m_name),
-             SharedTypes::MsgType2Text[SharedTypes::MessageType::Offline],
-             QUrl::toPercentEncoding(sensor_name));
+    auto sensor_offline = SharedTypes::format_offline_report(m_id, m_name, sensor_name);
+
+    journal_transition(file, sensor_name, SharedTypes::SensorState::Offline, msg);
+
+    if(m_damper)
+    {
+        m_damper->forget(file);
+        m_held_reports.remove(file);
+    }
+
+    m_published_states.remove(file);
 
     // Send the domain error to the multicast group
-    m_multicast_sender->send_datagram(sensor_offline.toUtf8());
+    m_multicast_sender->send_datagram(sensor_offline.toUtf8(), file);
+    m_instruments.offline_reports->increment();
 
     m_sensor_updates.remove(file);
 }
 
+void Collector::process_domain_offline(const QString& msg)
+{
+    // One notice takes every Sensor we have reported offline, rather than
+    // one datagram (and one Dashboard relayout) per Sensor.
+
+    if(m_queue_cache.isEmpty())
+        return;
+
+    qWarning() << msg;
+
+    for(auto iter = m_queue_cache.cbegin();iter != m_queue_cache.cend();++iter)
+        journal_transition(iter.key(), iter.value()[0].toString(), SharedTypes::SensorState::Offline, msg);
+
+    if(m_damper)
+    {
+        foreach(const QString& key, m_queue_cache.keys())
+            m_damper->forget(key);
+        m_held_reports.clear();
+    }
+
+    if(m_multicast_sender)
+    {
+        auto domain_offline = SharedTypes::format_domain_offline_report(m_id, m_name);
+        m_multicast_sender->send_datagram(domain_offline.toUtf8());
+    }
+    m_instruments.offline_reports->increment();
+
+    m_sensor_updates.clear();
+}
+
 bool Collector::process_sensor_update(const QString& file, QDateTime last_modified)
 {
+    TRACE_SPAN("Collector::process_sensor_update");
+
     bool result = false;
 
+    QElapsedTimer timer;
+    timer.start();
+
     QFile sensor_file(file);
     if(sensor_file.open(QIODevice::ReadOnly))
     {
         auto data = sensor_file.readAll();
         sensor_file.close();
+        m_instruments.read_seconds->observe_ns(timer.nsecsElapsed());
 
+        timer.restart();
         QJsonParseError error;
         auto doc = QJsonDocument::fromJson(data, &error);
+        m_instruments.parse_seconds->observe_ns(timer.nsecsElapsed());
         if(!doc.isNull())
-        {
-            QJsonObject object = doc.object();
-
-            if(object.contains("sensor_name") && object.contains("sensor_state"))
-            {
-                auto sensor_name = object["sensor_name"].toString();
-                auto sensor_state= object["sensor_state"].toString().toLower();
-                QString sensor_message;
-                if(object.contains("sensor_message"))
-                    sensor_message = object["sensor_message"].toString();
-
-                if(SharedTypes::MsgText2State.contains(sensor_state))
-                {
-                    auto sensor_data = QString("{ \"domain_id\" : \"%1\", \"domain_name\" : \"%2\", "
-                                               " \"type\" : \"%3\", "
-                                               " \"updated\" : \"%4\", "
-                                               " \"sensor_name\" : \"%5\", \"sensor_state\" : \"%6\", "
-                                               " \"sensor_message\" : \"%7\" }")
-                        .arg(m_id)
-                        .arg(QUrl::toPercentEncoding(m_name),
-                            SharedTypes::MsgType2Text[SharedTypes::MessageType::Sensor],
-                            QString::number(last_modified.toMSecsSinceEpoch()),
-                            QUrl::toPercentEncoding(sensor_name), sensor_state,
-                            QUrl::toPercentEncoding(sensor_message));
-
-                    // Send the sensor data to the multicast group
-                    if(!m_multicast_sender.isNull())
-                        m_multicast_sender->send_datagram(sensor_data.toUtf8());
-
-                    if(m_queue_cache.contains(file))
-                    {
-                        auto delta = m_queue_cache[file][1].toDateTime().msecsTo(last_modified);
-                        m_queue_cache[file][1] = last_modified;
-                        // Cache the most recent event report for each Sensor
-                        // so we can initialize newly active Dashboards
-                        m_queue_cache[file][2] = sensor_data;
-
-                        m_sensor_updates[file][0] += 1;
-                        m_sensor_updates[file][1] += delta;
-                    }
-                    else
-                    {
-                        // Add/update the cache info
-                        m_queue_cache[file] = SensorDataList();
-                        m_queue_cache[file].append(sensor_name);
-                        m_queue_cache[file].append(last_modified);
-                        m_queue_cache[file].append(sensor_data);
-
-                        m_sensor_updates[file] = UpdateDataList();
-                        m_sensor_updates[file].append(0);
-                        m_sensor_updates[file].append(0);
-                    }
-
-                    result = true;
-                }
-                else
-                {
-                    qWarning() << tr("Sensor \"") << sensor_name << tr("\" used invalid state value: \"") << sensor_state << "\".";
-                }
-            }
-        }
+            result = process_sensor_report(file, doc.object(), last_modified);
         else
         {
+            m_instruments.parse_failures->increment();
+
             // The JSON doc did not load--it could be empty, or it could be partial.
             // We'll leave it alone for now, and try to process it on the next event.
             qWarning() << tr("Failed to load Sensor data file: \"") << file << "\": " << error.errorString() << " (" << error.offset << ")";
@@ -467,14 +957,158 @@ bool Collector::process_sensor_update(const QString& file, QDateTime last_modifi
             }
         }
     }
+    else
+        m_instruments.read_failures->increment();
+
+    return result;
+}
+
+bool Collector::process_sensor_report(const QString& key, const QJsonObject& object, QDateTime last_modified)
+{
+    bool result = false;
+
+    if(object.contains("sensor_name") && object.contains("sensor_state"))
+    {
+        auto sensor_name = object["sensor_name"].toString();
+        auto sensor_state= object["sensor_state"].toString().toLower();
+        QString sensor_message;
+        if(object.contains("sensor_message"))
+            sensor_message = object["sensor_message"].toString();
+
+        if(SharedTypes::MsgText2State.contains(sensor_state))
+        {
+            auto state = SharedTypes::MsgText2State[sensor_state];
+
+            // The journal sees every change, even those damped below
+            journal_transition(key, sensor_name, state, sensor_message);
+
+            bool held = !m_damper.isNull() &&
+                        m_damper->offer(key, state, QDateTime::currentMSecsSinceEpoch()) == FlapDamper::Verdict::Hold;
+
+            QString sensor_data;
+            if(held)
+            {
+                HeldReport report{sensor_name, sensor_state, sensor_message, last_modified};
+                m_held_reports[key] = report;
+            }
+            else
+            {
+                m_held_reports.remove(key);
+                sensor_data = send_sensor_report(key, sensor_name, sensor_state, sensor_message, last_modified);
+            }
+
+            if(m_queue_cache.contains(key))
+            {
+                auto delta = m_queue_cache[key][1].toDateTime().msecsTo(last_modified);
+                m_queue_cache[key][1] = last_modified;
+                // Cache the most recent event report for each Sensor
+                // so we can initialize newly active Dashboards (a held
+                // report hasn't been published, so it isn't cached)
+                if(!held)
+                    m_queue_cache[key][2] = sensor_data;
+
+                m_sensor_updates[key][0] += 1;
+                m_sensor_updates[key][1] += delta;
+            }
+            else
+            {
+                // Add/update the cache info
+                m_queue_cache[key] = SensorDataList();
+                m_queue_cache[key].append(sensor_name);
+                m_queue_cache[key].append(last_modified);
+                m_queue_cache[key].append(sensor_data);
+
+                m_sensor_updates[key] = UpdateDataList();
+                m_sensor_updates[key].append(0);
+                m_sensor_updates[key].append(0);
+            }
+
+            result = true;
+        }
+        else
+        {
+            m_instruments.invalid_states->increment();
+            qWarning() << tr("Sensor \"") << sensor_name << tr("\" used invalid state value: \"") << sensor_state << "\".";
+        }
+    }
 
     return result;
 }
 
+QString Collector::send_sensor_report(const QString& key, const QString& sensor_name, const QString& sensor_state,
+                                      const QString& sensor_message, const QDateTime& last_modified)
+{
+    auto sensor_data = SharedTypes::format_sensor_report(m_id, m_name, last_modified.toMSecsSinceEpoch(),
+                                                         sensor_name, sensor_state, sensor_message);
+
+    // Send the sensor data to the multicast group
+    if(!m_multicast_sender.isNull())
+    {
+        QElapsedTimer timer;
+        timer.start();
+        m_multicast_sender->send_datagram(sensor_data.toUtf8(), key);
+        m_instruments.send_seconds->observe_ns(timer.nsecsElapsed());
+    }
+    m_instruments.reports->increment();
+
+    if(m_priority_sender)
+    {
+        // Sent on the routine group as well, for Dashboards that only join
+        // that one; those that join both drop the second copy as a repeat
+        auto state = SharedTypes::MsgText2State.value(sensor_state.toLower(), SharedTypes::SensorState::Undefined);
+        auto previous = m_published_states.value(key, SharedTypes::SensorState::Undefined);
+        if(state != previous &&
+           (state == SharedTypes::SensorState::Critical || state == SharedTypes::SensorState::Deceased))
+        {
+            m_priority_sender->send_datagram(sensor_data.toUtf8(), key);
+            m_instruments.priority_reports->increment();
+        }
+        m_published_states[key] = state;
+    }
+
+    return sensor_data;
+}
+
+void Collector::slot_release_damped()
+{
+    auto keys = m_damper->due(QDateTime::currentMSecsSinceEpoch());
+    foreach(const QString& key, keys)
+    {
+        if(!m_held_reports.contains(key) || !m_queue_cache.contains(key))
+            continue;
+
+        auto report = m_held_reports.take(key);
+        m_queue_cache[key][2] = send_sensor_report(key, report.sensor_name, report.sensor_state,
+                                                   report.sensor_message, report.last_modified);
+    }
+}
+
+void Collector::journal_transition(const QString& key, const QString& sensor_name, SharedTypes::SensorState state, const QString& message)
+{
+    if(m_journal.isNull())
+        return;
+
+    auto old_state = m_journal_states.value(key, SharedTypes::SensorState::Undefined);
+    if(old_state == state)
+        return;
+
+    if(state == SharedTypes::SensorState::Offline)
+        m_journal_states.remove(key);
+    else
+        m_journal_states[key] = state;
+
+    if(m_journal->append(sensor_name, static_cast<quint8>(old_state), static_cast<quint8>(state), message))
+        m_instruments.journal_records->increment();
+}
+
 void Collector::slot_directory_event(const QString& dir)
 {
     Q_UNUSED(dir)
 
+    TRACE_SPAN("Collector::slot_directory_event");
+
+    m_instruments.directory_events->increment();
+
     // Perform a delta on the folder and see if there are any new or removed files
 
     QDir directory(m_queue_path);
@@ -501,8 +1135,12 @@ void Collector::slot_directory_event(const QString& dir)
         if(!new_file.isEmpty())
         {
             qInfo() << tr("Processing Sensor add: \"") << new_file << "\"";
+            QElapsedTimer timer;
+            timer.start();
             if(process_sensor_update(new_file, info.lastModified()))
             {
+                m_instruments.pipeline_seconds->observe_ns(timer.nsecsElapsed());
+
                 // The file was added to our cache, update our
                 // file system watcher to tell us about events
 
@@ -515,6 +1153,10 @@ void Collector::slot_directory_event(const QString& dir)
     auto keys = m_queue_cache.keys();
     foreach(QString key, keys)
     {
+        // Sensors reporting over the local socket or shared memory have no file to go missing
+        if(!is_file_key(key))
+            continue;
+
         if(!QFile::exists(key))
         {
             qInfo() << tr("Processing Sensor offline: \"") << key << "\"";
@@ -529,7 +1171,16 @@ void Collector::slot_directory_event(const QString& dir)
 
 void Collector::slot_file_event(const QString& file)
 {
+    QElapsedTimer timer;
+    timer.start();
+
+    m_instruments.file_events->increment();
+
+    TRACE_SPAN("Collector::slot_file_event");
+
     const QFileInfo info(file);
+    // From the Sensor writing its file to us hearing about it
+    TRACE_SPAN_SINCE("sensor_file_write", info.lastModified().toMSecsSinceEpoch() * 1000);
 
     if(m_queue_cache.contains(file))
     {
@@ -538,14 +1189,80 @@ void Collector::slot_file_event(const QString& file)
         if(abs(m_queue_cache[file][1].toDateTime().msecsTo(now)) < 1000)
         {
             // qInfo() << tr("└─ Sensor event \"") << file << tr("\" is updating too fast; ignoring.");
+            m_instruments.debounced_events->increment();
             return;
         }
     }
 
     qInfo() << tr("Processing Sensor event: \"") << file << "\"";
-    process_sensor_update(file, info.lastModified());
+    if(process_sensor_update(file, info.lastModified()))
+        m_instruments.pipeline_seconds->observe_ns(timer.nsecsElapsed());
 }
 
+#ifdef QT_LINUX
+void Collector::slot_local_report(const QByteArray& report, qint64 sender_pid)
+{
+    m_instruments.local_reports->increment();
+
+    QJsonParseError error;
+    auto doc = QJsonDocument::fromJson(report, &error);
+    if(doc.isNull())
+    {
+        qWarning() << tr("Discarding malformed Sensor report from process ") << sender_pid << ": " << error.errorString() << " (" << error.offset << ")";
+        return;
+    }
+
+    auto object = doc.object();
+    if(!object.contains("sensor_name"))
+        return;
+
+    // Socket Sensors are keyed by name rather than by file, so a Sensor
+    // keeps its cache entry across restarts of its process.
+    auto key = QString("%1%2").arg(local_key_prefix, object["sensor_name"].toString());
+
+    // With no file to remove, a socket Sensor announces its departure
+    // with an "offline" state.
+    if(!object["sensor_state"].toString().compare("offline", Qt::CaseInsensitive))
+    {
+        if(m_queue_cache.contains(key))
+        {
+            process_sensor_offline(key, tr("Sensor \"%1\" has gone offline.").arg(object["sensor_name"].toString()));
+            m_queue_cache.remove(key);
+        }
+        return;
+    }
+
+    process_sensor_report(key, object, QDateTime::currentDateTime());
+}
+
+void Collector::slot_shm_changed(uint32_t slot, const QString& sensor_name, SharedTypes::SensorState state, const QString& message, const QDateTime& updated)
+{
+    m_instruments.shm_reports->increment();
+
+    auto key = QString("%1%2").arg(shm_key_prefix, sensor_name);
+
+    if(state == SharedTypes::SensorState::Offline)
+    {
+        if(m_queue_cache.contains(key))
+        {
+            process_sensor_offline(key, tr("Sensor \"%1\" has released its shared-memory slot.").arg(sensor_name));
+            m_queue_cache.remove(key);
+        }
+
+        m_slot_table->free_slot(slot);
+        return;
+    }
+
+    QJsonObject object;
+    object["sensor_name"] = sensor_name;
+    object["sensor_state"] = SharedTypes::MsgState2Text[state];
+    if(!message.isEmpty())
+        object["sensor_message"] = message;
+
+    process_sensor_report(key, object, updated);
+}
+#endif
+
 void Collector::slot_process_peer_event(const QByteArray& datagram)
 {
     auto doc{QJsonDocument::fromJson(datagram)};
@@ -558,20 +1275,28 @@ void Collector::slot_process_peer_event(const QByteArray& datagram)
         {
             auto action = object["action"].toString();
             if(!action.compare("initialize"))
+            {
+                m_instruments.initialize_requests->increment();
                 QTimer::singleShot(0, this, &Collector::slot_broadcast_cached_events);
+            }
         }
     }
 }
 
 void Collector::slot_broadcast_cached_events()
 {
-    // (re)Send all of our cached event reports
+    // (re)Send all of our cached event reports in as few syscalls as we can
     auto keys = m_queue_cache.keys();
+    QList<QByteArray> reports;
+    reports.reserve(keys.count());
     foreach(QString key, keys)
-    {
-        auto report = m_queue_cache[key][2];
-        m_multicast_sender->send_datagram(report.toByteArray());
-    }
+        reports.append(m_queue_cache[key][2].toByteArray());
+
+    m_multicast_sender->send_datagrams(reports, keys);
+
+    // A relay answers for the Domains it forwards
+    if(m_relay)
+        m_relay->rebroadcast();
 }
 
 void Collector::slot_housekeeping()
@@ -593,6 +1318,7 @@ void Collector::slot_housekeeping()
                 {
                     // Consider this one offline.
                     qInfo() << tr("Processing Sensor offline: \"") << key << "\" (avg: " << average_cadence << ", delta: " << delta << ")";
+                    m_instruments.offline_detections->increment();
                     process_sensor_offline(key, tr("Sensor update overdue; flagging offline."));
                 }
             }
@@ -642,6 +1368,9 @@ void Collector::load_settings()
         m_port = settings.value("port", SharedTypes::MULTICAST_PORT).toString().toUShort();
         m_queue_path = settings.value("queue-folder", "").toString();
         m_log_path = settings.value("log-folder", "").toString();
+        m_log_level = settings.value("log-level", "info").toString();
+        m_socket_path = settings.value("socket", "").toString();
+        m_shm_name = settings.value("shm", "").toString();
         // m_clean_on_startup = settings.value("clean-on-startup", true).toBool();
     settings.endGroup();
 }
@@ -659,6 +1388,9 @@ void Collector::save_settings()
         settings.setValue("port", m_port);
         settings.setValue("queue-folder", m_queue_path);
         settings.setValue("log-folder", m_log_path);
+        settings.setValue("log-level", m_log_level);
+        settings.setValue("socket", m_socket_path);
+        settings.setValue("shm", m_shm_name);
         // settings.setValue("clean-on-startup", m_clean_on_startup);
     settings.endGroup();
 }
@@ -3,12 +3,23 @@
 #include <QFile>
 #include <QTimer>
 #include <QDateTime>
+#include <QJsonObject>
 #include <QCoreApplication>
 #include <QFileSystemWatcher>
 #include <QSharedPointer>
 
 #include "Sender.h"
 #include "Receiver.h"
+#ifdef QT_LINUX
+#include "LocalReceiver.h"
+#include "SlotTable.h"
+#endif
+#include "Relay.h"
+#include "Metrics.h"
+#include "MetricsServer.h"
+#include "LogWriter.h"
+#include "Journal.h"
+#include "FlapDamper.h"
 
 //---------------------------------------------------------------------------
 // Dash'd Collector
@@ -40,8 +51,13 @@ private slots:
     void        slot_directory_event(const QString&);
     void        slot_broadcast_cached_events();
     void        slot_file_event(const QString&);
+#ifdef QT_LINUX
+    void        slot_local_report(const QByteArray& report, qint64 sender_pid);
+    void        slot_shm_changed(uint32_t slot, const QString& sensor_name, SharedTypes::SensorState state, const QString& message, const QDateTime& updated);
+#endif
     void        slot_housekeeping();
     void        slot_process_peer_event(const QByteArray&);
+    void        slot_release_damped();
 
 private:    // typedefs and enums
     using WatcherPtr = QSharedPointer<QFileSystemWatcher>;
@@ -51,11 +67,61 @@ private:    // typedefs and enums
     using QueueMap = QMap<QString, SensorDataList>;
     using UpdateDataList = QList<qint64>;
     using UpdateMap = QMap<QString, UpdateDataList>;
+    using StateMap = QHash<QString, SharedTypes::SensorState>;
+
+    // A damped state change, waiting to be published
+    struct HeldReport
+    {
+        QString     sensor_name;
+        QString     sensor_state;
+        QString     sensor_message;
+        QDateTime   last_modified;
+    };
+    using HeldMap = QHash<QString, HeldReport>;
+
+    // The pipeline's instruments, registered once in initialize_metrics()
+    struct Instruments
+    {
+        Counter*    directory_events{nullptr};
+        Counter*    file_events{nullptr};
+        Counter*    debounced_events{nullptr};
+        Counter*    read_failures{nullptr};
+        Counter*    parse_failures{nullptr};
+        Counter*    invalid_states{nullptr};
+        Counter*    reports{nullptr};
+        Counter*    local_reports{nullptr};
+        Counter*    shm_reports{nullptr};
+        Counter*    offline_reports{nullptr};
+        Counter*    offline_detections{nullptr};
+        Counter*    initialize_requests{nullptr};
+        Counter*    journal_records{nullptr};
+        Counter*    priority_reports{nullptr};
+
+        Histogram*  read_seconds{nullptr};
+        Histogram*  parse_seconds{nullptr};
+        Histogram*  send_seconds{nullptr};
+        Histogram*  pipeline_seconds{nullptr};
+    };
+
+    // Cache keys for Sensors reporting over the local socket carry this prefix
+    static constexpr const char* local_key_prefix{"socket:"};
+    // ...and for Sensors writing into the shared-memory slot table, this one
+    static constexpr const char* shm_key_prefix{"shm:"};
+
+    // How often held state changes are checked for release
+    static constexpr int damping_interval{250};  // milliseconds
 
 private:    // methods
     void        initialize_watcher();
+    void        initialize_metrics();
+    bool        is_file_key(const QString& key) const { return !key.startsWith(local_key_prefix) && !key.startsWith(shm_key_prefix); }
     void        process_sensor_offline(const QString& file, const QString& msg);
+    void        process_domain_offline(const QString& msg);
     bool        process_sensor_update(const QString& file, QDateTime last_modified);
+    bool        process_sensor_report(const QString& key, const QJsonObject& object, QDateTime last_modified);
+    QString     send_sensor_report(const QString& key, const QString& sensor_name, const QString& sensor_state,
+                                   const QString& sensor_message, const QDateTime& last_modified);
+    void        journal_transition(const QString& key, const QString& sensor_name, SharedTypes::SensorState state, const QString& message);
 
     void        load_settings();
     void        save_settings();
@@ -64,29 +130,64 @@ private:    // data members
     std::uint64_t   m_id{0};
     QString     m_name;
 
-    FilePtr     m_log;
+    LogWriterPtr m_log;
+    QString     m_log_level{"info"};
 
     QString     m_queue_path;
     QueueMap    m_queue_cache;
 
     QString     m_log_path;
 
+    JournalPtr  m_journal;
+    // The last state journaled for each cache key
+    StateMap    m_journal_states;
+
     WatcherPtr  m_watcher;
     SenderPtr   m_multicast_sender;
     ReceiverPtr m_multicast_receiver;
 
+    // Optional: Critical and Deceased transitions are also sent here, ahead
+    // of routine traffic
+    SenderPtr   m_priority_sender;
+    // The last state published for each cache key, while there is a priority group
+    StateMap    m_published_states;
+
+    QString     m_socket_path;
+#ifdef QT_LINUX
+    LocalReceiverPtr m_local_receiver;
+#endif
+
+    QString     m_shm_name;
+#ifdef QT_LINUX
+    SlotTablePtr m_slot_table;
+#endif
+
+    // In relay mode, we forward another ring instead of watching a queue
+    ReceiverPtr m_relay_receiver;
+    RelayPtr    m_relay;
+
     QDateTime   m_start_time;
 
+    MetricsPtr  m_metrics;
+    Instruments m_instruments;
+    MetricsServerPtr m_metrics_server;
+
     QString     m_ip4_group;
     QString     m_ip6_group;
     uint16_t    m_port{20856};
 
     bool        m_detect_offline{false};
+    // Shut down with an offline notice per Sensor instead of one for the Domain
+    bool        m_legacy_offline{false};
     // By how much should we multiply a Sensor's update cadence in order
     // to reasonably detect that it has gone offline?
     int         m_offline_detection_multiplier{2};
     UpdateMap   m_sensor_updates;
     TimerPtr    m_housekeeping;
 
+    FlapDamperPtr m_damper;
+    HeldMap     m_held_reports;
+    TimerPtr    m_damping_timer;
+
     QString     m_settings_filename;
 };
@@ -0,0 +1,146 @@
+#include <cmath>
+
+#include "FlapDamper.h"
+
+FlapDamper::FlapDamper(const Settings& settings)
+    : m_settings(settings)
+{
+    m_settings.window = qBound(1, m_settings.window, 32);
+    m_settings.confirm = qBound(1, m_settings.confirm, m_settings.window);
+    m_settings.dwell = qMax<qint64>(0, m_settings.dwell);
+    m_settings.half_life = qMax(0, m_settings.half_life);
+
+    m_window_mask = (m_settings.window == 32) ? 0xFFFFFFFFu : ((1u << m_settings.window) - 1);
+}
+
+FlapDamper::Verdict FlapDamper::offer(const QString& key, SharedTypes::SensorState state, qint64 now)
+{
+    auto& entry = m_entries[key];
+
+    // A Sensor's first report is news, not a flap
+    if(entry.published == SharedTypes::SensorState::Undefined)
+    {
+        entry.published = state;
+        return Verdict::Publish;
+    }
+
+    decay(entry, now);
+
+    if(state != entry.published && state != entry.candidate)
+    {
+        // Heading somewhere new
+        entry.candidate = state;
+        entry.candidate_since = now;
+        entry.window = 0;
+
+        if(m_settings.half_life)
+        {
+            entry.penalty = qMin(entry.penalty + m_settings.penalty, m_settings.max_penalty);
+            if(entry.penalty >= m_settings.suppress)
+                entry.is_suppressed = true;
+        }
+    }
+
+    entry.window = ((entry.window << 1) | (state == entry.candidate ? 1u : 0u)) & m_window_mask;
+
+    if(state == entry.published)
+    {
+        if(m_holding.remove(key))
+            ++m_discarded;
+
+        // The candidate has dropped out of the window entirely
+        if(entry.window == 0)
+            entry.candidate = SharedTypes::SensorState::Undefined;
+
+        return Verdict::Publish;
+    }
+
+    if(is_confirmed(entry, now))
+    {
+        publish(key, entry);
+        return Verdict::Publish;
+    }
+
+    if(!m_holding.contains(key))
+    {
+        m_holding.insert(key);
+        ++m_held;
+    }
+
+    return Verdict::Hold;
+}
+
+QStringList FlapDamper::due(qint64 now)
+{
+    QStringList keys;
+
+    foreach(const QString& key, m_holding)
+    {
+        auto& entry = m_entries[key];
+        decay(entry, now);
+        if(is_confirmed(entry, now))
+            keys.append(key);
+    }
+
+    foreach(const QString& key, keys)
+    {
+        publish(key, m_entries[key]);
+        ++m_released;
+    }
+
+    return keys;
+}
+
+void FlapDamper::forget(const QString& key)
+{
+    m_entries.remove(key);
+    m_holding.remove(key);
+}
+
+int FlapDamper::suppressed() const
+{
+    int count{0};
+    foreach(const Entry& entry, m_entries)
+    {
+        if(entry.is_suppressed)
+            ++count;
+    }
+    return count;
+}
+
+void FlapDamper::decay(Entry& entry, qint64 now) const
+{
+    if(!m_settings.half_life || entry.penalty == 0.0)
+    {
+        entry.penalty_at = now;
+        return;
+    }
+
+    auto elapsed = static_cast<double>(now - entry.penalty_at) / 1000.0;
+    entry.penalty *= std::pow(0.5, elapsed / m_settings.half_life);
+    entry.penalty_at = now;
+
+    if(entry.is_suppressed && entry.penalty < m_settings.reuse)
+        entry.is_suppressed = false;
+    if(entry.penalty < 1.0)
+        entry.penalty = 0.0;
+}
+
+bool FlapDamper::is_confirmed(const Entry& entry, qint64 now) const
+{
+    int seen{0};
+    for(auto bits = entry.window;bits;bits &= bits - 1)
+        ++seen;
+
+    return !entry.is_suppressed &&
+           seen >= m_settings.confirm &&
+           (now - entry.candidate_since) >= m_settings.dwell;
+}
+
+void FlapDamper::publish(const QString& key, Entry& entry)
+{
+    entry.published = entry.candidate;
+    entry.candidate = SharedTypes::SensorState::Undefined;
+    entry.window = 0;
+    m_holding.remove(key);
+}
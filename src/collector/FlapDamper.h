@@ -0,0 +1,100 @@
+#pragma once
+
+#include <QSet>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QSharedPointer>
+
+#include "SharedTypes.h"
+
+//---------------------------------------------------------------------------
+// FlapDamper
+//
+// Decides whether a Sensor's change of state goes out to the ring now, or
+// is held back because the Sensor is flapping.  Reports that keep the
+// published state always pass; a report with a new state is held until:
+//
+//   - it has been seen in 'confirm' of the Sensor's last 'window' reports
+//     (N-of-M confirmation),
+//   - the new state has lasted at least 'dwell' milliseconds, and
+//   - the Sensor is not suppressed.
+//
+// Suppression works like BGP route-flap damping: every change of direction
+// adds 'penalty' to the Sensor's score, which decays with a half-life of
+// 'half_life' seconds.  Past 'suppress', changes are held until the score
+// decays below 'reuse'.
+//
+// A held change that the Sensor reverts before it is released is never
+// published at all.  Held changes that become publishable between reports
+// are collected with due().
+//---------------------------------------------------------------------------
+
+class FlapDamper
+{
+public:
+    struct Settings
+    {
+        int         confirm{1};
+        int         window{1};          // reports (at most 32)
+        qint64      dwell{0};           // milliseconds
+        int         half_life{0};       // seconds (0 = no flap penalties)
+        double      penalty{1000.0};
+        double      suppress{2000.0};
+        double      reuse{750.0};
+        double      max_penalty{12000.0};
+    };
+
+    enum class Verdict {
+        Publish,
+        Hold
+    };
+
+public:
+    explicit FlapDamper(const Settings& settings);
+
+    const Settings& settings() const { return m_settings; }
+
+    Verdict     offer(const QString& key, SharedTypes::SensorState state, qint64 now);
+    // Sensors whose held change can now be published (and is considered so)
+    QStringList due(qint64 now);
+    void        forget(const QString& key);
+
+    quint64     held() const { return m_held; }
+    quint64     released() const { return m_released; }
+    quint64     discarded() const { return m_discarded; }
+    int         holding() const { return m_holding.count(); }
+    int         suppressed() const;
+
+private:    // typedefs and enums
+    struct Entry
+    {
+        SharedTypes::SensorState published{SharedTypes::SensorState::Undefined};
+        SharedTypes::SensorState candidate{SharedTypes::SensorState::Undefined};
+        qint64      candidate_since{0};
+        quint32     window{0};          // bit per recent report: 1 = matched the candidate
+        double      penalty{0.0};
+        qint64      penalty_at{0};
+        bool        is_suppressed{false};
+    };
+
+    using EntryMap = QHash<QString, Entry>;
+
+private:    // methods
+    void        decay(Entry& entry, qint64 now) const;
+    bool        is_confirmed(const Entry& entry, qint64 now) const;
+    void        publish(const QString& key, Entry& entry);
+
+private:    // data members
+    Settings    m_settings;
+    quint32     m_window_mask{1};
+
+    EntryMap    m_entries;
+    QSet<QString> m_holding;
+
+    quint64     m_held{0};
+    quint64     m_released{0};
+    quint64     m_discarded{0};
+};
+
+using FlapDamperPtr = QSharedPointer<FlapDamper>;
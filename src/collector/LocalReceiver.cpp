@@ -0,0 +1,177 @@
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <cstring>
+
+#include <QFile>
+#include <QDateTime>
+
+#include "LocalReceiver.h"
+#include "Logging.h"
+
+LocalReceiver::LocalReceiver(const QString& path, QObject* parent)
+    : QObject(parent),
+      m_path(path)
+{
+    auto native_path = QFile::encodeName(m_path);
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if(static_cast<size_t>(native_path.size()) >= sizeof(addr.sun_path))
+    {
+        qCritical() << tr("Socket path \"") << m_path << tr("\" is too long.");
+        return;
+    }
+    memcpy(addr.sun_path, native_path.constData(), static_cast<size_t>(native_path.size()));
+
+    m_fd = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(m_fd < 0)
+    {
+        qCritical() << tr("Could not create local socket: ") << strerror(errno);
+        return;
+    }
+
+    // A stale socket left behind by a previous run would make bind() fail
+    ::unlink(native_path.constData());
+
+    if(::bind(m_fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)
+    {
+        qCritical() << tr("Could not bind local socket \"") << m_path << "\": " << strerror(errno);
+        ::close(m_fd);
+        m_fd = -1;
+        return;
+    }
+
+    // Ask the kernel to attach the sender's credentials so we can
+    // rate limit per process.
+    int on = 1;
+    ::setsockopt(m_fd, SOL_SOCKET, SO_PASSCRED, &on, sizeof(on));
+
+    m_notifier = NotifierPtr(new QSocketNotifier(m_fd, QSocketNotifier::Read));
+    connect(m_notifier.data(), &QSocketNotifier::activated, this, &LocalReceiver::slot_process_datagrams);
+}
+
+LocalReceiver::~LocalReceiver()
+{
+    m_notifier.clear();
+
+    if(m_fd >= 0)
+    {
+        ::close(m_fd);
+        ::unlink(QFile::encodeName(m_path).constData());
+    }
+}
+
+void LocalReceiver::set_rate_limit(int per_second, int burst)
+{
+    m_rate = qMax(1, per_second);
+    m_burst = qMax(m_rate, burst);
+    m_buckets.clear();
+}
+
+bool LocalReceiver::admit(qint64 sender_pid, qint64 now)
+{
+    if(!m_buckets.contains(sender_pid))
+    {
+        if(m_buckets.count() >= max_buckets)
+            prune_buckets(now);
+
+        Bucket bucket;
+        bucket.tokens = m_burst;
+        bucket.last_refill = now;
+        m_buckets[sender_pid] = bucket;
+    }
+
+    auto& bucket = m_buckets[sender_pid];
+
+    auto elapsed = now - bucket.last_refill;
+    bucket.tokens = qMin(static_cast<double>(m_burst), bucket.tokens + (elapsed * m_rate) / 1000.0);
+    bucket.last_refill = now;
+
+    if(bucket.tokens < 1.0)
+        return false;
+
+    bucket.tokens -= 1.0;
+    return true;
+}
+
+void LocalReceiver::prune_buckets(qint64 now)
+{
+    // A bucket that has had time to refill completely carries no
+    // state worth keeping.
+    auto refill_time = (m_burst * 1000) / m_rate;
+
+    auto iter = m_buckets.begin();
+    while(iter != m_buckets.end())
+    {
+        if(now - iter.value().last_refill > refill_time)
+            iter = m_buckets.erase(iter);
+        else
+            ++iter;
+    }
+}
+
+void LocalReceiver::slot_process_datagrams()
+{
+    QByteArray buffer(max_report_size, Qt::Uninitialized);
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof(struct ucred))];
+    } control;
+
+    auto now = QDateTime::currentMSecsSinceEpoch();
+
+    for(int count = 0;count < max_batch;++count)
+    {
+        struct iovec iov;
+        iov.iov_base = buffer.data();
+        iov.iov_len = static_cast<size_t>(buffer.size());
+
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.buf;
+        msg.msg_controllen = sizeof(control.buf);
+
+        auto bytes = ::recvmsg(m_fd, &msg, 0);
+        if(bytes < 0)
+        {
+            if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                qWarning() << tr("Local socket receive failed: ") << strerror(errno);
+            break;
+        }
+
+        ++m_received;
+
+        if(msg.msg_flags & MSG_TRUNC)
+        {
+            qWarning() << tr("Discarding oversized Sensor report on local socket.");
+            ++m_dropped;
+            continue;
+        }
+
+        qint64 sender_pid{0};
+        for(auto cmsg = CMSG_FIRSTHDR(&msg);cmsg;cmsg = CMSG_NXTHDR(&msg, cmsg))
+        {
+            if(cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_CREDENTIALS)
+            {
+                struct ucred cred;
+                memcpy(&cred, CMSG_DATA(cmsg), sizeof(cred));
+                sender_pid = cred.pid;
+            }
+        }
+
+        if(!admit(sender_pid, now))
+        {
+            ++m_dropped;
+            continue;
+        }
+
+        emit signal_report_available(QByteArray(buffer.constData(), static_cast<int>(bytes)), sender_pid);
+    }
+}
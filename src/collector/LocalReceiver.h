@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QMap>
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QSocketNotifier>
+#include <QSharedPointer>
+
+//---------------------------------------------------------------------------
+// LocalReceiver
+//
+// Listens on a Unix-domain datagram socket for Sensor reports pushed
+// directly by local Sensor processes.  Each datagram carries the same JSON
+// payload a Sensor would otherwise write into the queue folder.
+//
+// Backpressure comes from the socket itself: we only drain a bounded number
+// of datagrams per event loop pass, and once the kernel queue is full a
+// Sensor's send() blocks (or fails with EAGAIN if it is non-blocking).
+// Each sending process is additionally held to a token-bucket rate limit;
+// reports over the limit are discarded and counted.
+//---------------------------------------------------------------------------
+
+class LocalReceiver : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LocalReceiver(const QString& path, QObject* parent = nullptr);
+    ~LocalReceiver();
+
+    bool        is_listening() const { return m_fd >= 0; }
+    QString     path() const { return m_path; }
+
+    // Sustained reports per second, and the burst allowed above that, per sending process
+    void        set_rate_limit(int per_second, int burst);
+
+    quint64     received() const { return m_received; }
+    quint64     dropped() const { return m_dropped; }
+
+signals:
+    void        signal_report_available(const QByteArray& report, qint64 sender_pid);
+
+private slots:
+    void        slot_process_datagrams();
+
+private:    // typedefs and enums
+    struct Bucket
+    {
+        double  tokens{0.0};
+        qint64  last_refill{0};
+    };
+
+    using BucketMap = QMap<qint64, Bucket>;
+    using NotifierPtr = QSharedPointer<QSocketNotifier>;
+
+    // Largest report we will accept; anything bigger is truncated by the kernel and dropped
+    static constexpr int max_report_size{64 * 1024};
+    // How many datagrams we drain before yielding back to the event loop
+    static constexpr int max_batch{64};
+    // How many distinct senders we track before pruning idle buckets
+    static constexpr int max_buckets{1024};
+
+private:    // methods
+    bool        admit(qint64 sender_pid, qint64 now);
+    void        prune_buckets(qint64 now);
+
+private:    // data members
+    QString     m_path;
+    int         m_fd{-1};
+
+    NotifierPtr m_notifier;
+
+    int         m_rate{20};
+    int         m_burst{40};
+    BucketMap   m_buckets;
+
+    quint64     m_received{0};
+    quint64     m_dropped{0};
+};
+
+using LocalReceiverPtr = QSharedPointer<LocalReceiver>;
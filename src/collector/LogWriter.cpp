@@ -0,0 +1,250 @@
+#include <cstdio>
+
+#include <QMap>
+#include <QDir>
+#include <QDateTime>
+#include <QFileInfo>
+
+#include "LogWriter.h"
+
+LogWriter::LogWriter(const QString& path, const Rotation& rotation)
+    : m_path(path),
+      m_rotation(rotation),
+      m_head(&m_stub),
+      m_tail(&m_stub),
+      m_level(severity(QtInfoMsg))
+{
+    if(!m_path.isEmpty())
+    {
+        m_file.setFileName(m_path);
+        if(m_file.open(QIODevice::WriteOnly | QIODevice::Append))
+            m_opened = QDateTime::currentMSecsSinceEpoch();
+    }
+
+    m_thread = std::thread([this]() { run(); });
+}
+
+LogWriter::~LogWriter()
+{
+    m_running.store(false, std::memory_order_release);
+    m_wake.notify_one();
+    if(m_thread.joinable())
+        m_thread.join();
+}
+
+int LogWriter::severity(QtMsgType type)
+{
+    // QtMsgType's values are not in order of severity
+    switch(type)
+    {
+        case QtDebugMsg:    return 0;
+        case QtInfoMsg:     return 1;
+        case QtWarningMsg:  return 2;
+        case QtCriticalMsg: return 3;
+        case QtFatalMsg:    return 4;
+    }
+    return 1;
+}
+
+bool LogWriter::parse_level(const QString& name, QtMsgType& level)
+{
+    static const QMap<QString, QtMsgType> levels {
+        { "debug", QtDebugMsg },
+        { "info", QtInfoMsg },
+        { "warning", QtWarningMsg },
+        { "critical", QtCriticalMsg },
+    };
+
+    auto key = name.trimmed().toLower();
+    if(!levels.contains(key))
+        return false;
+
+    level = levels[key];
+    return true;
+}
+
+void LogWriter::push(Node* node)
+{
+    node->next.store(nullptr, std::memory_order_relaxed);
+    auto* previous = m_head.exchange(node, std::memory_order_acq_rel);
+    previous->next.store(node, std::memory_order_release);
+}
+
+LogWriter::Node* LogWriter::pop()
+{
+    auto* tail = m_tail;
+    auto* next = tail->next.load(std::memory_order_acquire);
+
+    if(tail == &m_stub)
+    {
+        if(!next)
+            return nullptr;
+        m_tail = next;
+        tail = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+
+    if(next)
+    {
+        m_tail = next;
+        return tail;
+    }
+
+    // A producer may be between its exchange and its link; come back later
+    if(tail != m_head.load(std::memory_order_acquire))
+        return nullptr;
+
+    push(&m_stub);
+
+    next = tail->next.load(std::memory_order_acquire);
+    if(next)
+    {
+        m_tail = next;
+        return tail;
+    }
+
+    return nullptr;
+}
+
+void LogWriter::write(QtMsgType type, const QString& message)
+{
+    if(!is_enabled(type))
+        return;
+
+    if(m_pending.fetch_add(1, std::memory_order_relaxed) >= max_pending)
+    {
+        m_pending.fetch_sub(1, std::memory_order_relaxed);
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    auto* node = new Node();
+    node->stamp = QDateTime::currentMSecsSinceEpoch();
+    node->type = type;
+    node->text = message;
+    push(node);
+    m_queued.fetch_add(1, std::memory_order_release);
+
+    // The writer wakes on its own every flush_interval; only hurry it
+    // along for a backlog or for anything worth seeing right away.
+    if(m_pending.load(std::memory_order_relaxed) == wake_pending || severity(type) >= severity(QtWarningMsg))
+        m_wake.notify_one();
+}
+
+void LogWriter::flush()
+{
+    auto target = m_queued.load(std::memory_order_acquire);
+    m_wake.notify_one();
+
+    while(m_running.load(std::memory_order_acquire) && m_written.load(std::memory_order_acquire) < target)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+void LogWriter::run()
+{
+    while(m_running.load(std::memory_order_acquire))
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_wake_lock);
+            m_wake.wait_for(lock, std::chrono::milliseconds(flush_interval));
+        }
+
+        drain();
+    }
+
+    // Whatever was queued before we were told to stop still goes out
+    drain();
+}
+
+void LogWriter::drain()
+{
+    static const char* tags[] = { "Debug", "Info", "Warning", "Critical", "Fatal" };
+
+    QByteArray out_batch;
+    QByteArray err_batch;
+    quint64 count{0};
+
+    while(auto* node = pop())
+    {
+        // QDateTime::toString() is costly; format each second only once
+        auto second = node->stamp / 1000;
+        if(second != m_last_second)
+        {
+            m_last_second = second;
+            m_last_second_text = QDateTime::fromMSecsSinceEpoch(node->stamp).toString();
+        }
+
+        auto line = QString("[%1] %2: %3\n").arg(tags[severity(node->type)], m_last_second_text, node->text).toUtf8();
+
+        if(!m_path.isEmpty() || severity(node->type) < severity(QtWarningMsg))
+            out_batch += line;
+        else
+            err_batch += line;
+
+        delete node;
+        ++count;
+    }
+
+    if(count == 0)
+        return;
+
+    m_pending.fetch_sub(static_cast<int>(count), std::memory_order_relaxed);
+
+    auto dropped = m_dropped.load(std::memory_order_relaxed);
+    if(dropped > m_reported)
+    {
+        err_batch += QString("[Warning] %1: %2 log messages were dropped; the log could not keep up.\n")
+                        .arg(m_last_second_text).arg(dropped - m_reported).toUtf8();
+        m_reported = dropped;
+    }
+
+    if(m_path.isEmpty())
+    {
+        if(!out_batch.isEmpty())
+        {
+            fwrite(out_batch.constData(), 1, static_cast<size_t>(out_batch.size()), stdout);
+            fflush(stdout);
+        }
+        if(!err_batch.isEmpty())
+        {
+            fwrite(err_batch.constData(), 1, static_cast<size_t>(err_batch.size()), stderr);
+            fflush(stderr);
+        }
+    }
+    else if(m_file.isOpen())
+    {
+        rotate_if_needed();
+        m_file.write(out_batch);
+        m_file.write(err_batch);
+        m_file.flush();
+    }
+
+    m_written.fetch_add(count, std::memory_order_release);
+}
+
+void LogWriter::rotate_if_needed()
+{
+    bool too_big = m_rotation.max_size > 0 && m_file.size() >= m_rotation.max_size;
+    bool too_old = m_rotation.max_age > 0 &&
+                   (QDateTime::currentMSecsSinceEpoch() - m_opened) >= static_cast<qint64>(m_rotation.max_age) * 3600 * 1000;
+
+    if(too_big || too_old)
+        rotate();
+}
+
+void LogWriter::rotate()
+{
+    m_file.close();
+
+    // dash-d.log.(n-1) -> dash-d.log.n, ..., dash-d.log -> dash-d.log.1
+    QFile::remove(QString("%1.%2").arg(m_path).arg(m_rotation.keep));
+    for(int i = m_rotation.keep - 1;i >= 1;--i)
+        QFile::rename(QString("%1.%2").arg(m_path).arg(i), QString("%1.%2").arg(m_path).arg(i + 1));
+    if(m_rotation.keep > 0)
+        QFile::rename(m_path, QString("%1.1").arg(m_path));
+    else
+        QFile::remove(m_path);
+
+    if(m_file.open(QIODevice::WriteOnly | QIODevice::Append))
+        m_opened = QDateTime::currentMSecsSinceEpoch();
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include <QFile>
+#include <QString>
+#include <QByteArray>
+#include <QSharedPointer>
+
+//---------------------------------------------------------------------------
+// LogWriter
+//
+// Takes log output off the event loop.  Messages are pushed onto a lock-free
+// multi-producer/single-consumer queue (a push is one atomic exchange) and
+// a background thread formats them and writes them out in batches, so the
+// pipeline never waits on the disk or the console.
+//
+// Messages below the current level are discarded before they are queued.
+// If the writer falls hopelessly behind, new messages are dropped (and
+// counted) rather than letting the queue grow without bound.
+//
+// The log file is rotated when it grows past a size limit and/or after a
+// fixed age: dash-d.log becomes dash-d.log.1, and so on, keeping a set
+// number of old files.
+//---------------------------------------------------------------------------
+
+class LogWriter
+{
+public:
+    struct Rotation
+    {
+        qint64      max_size{10 * 1024 * 1024};     // bytes (0 = no limit)
+        int         max_age{0};                     // hours (0 = no limit)
+        int         keep{5};                        // rotated files kept
+    };
+
+public:
+    // An empty path writes to the console
+    LogWriter(const QString& path, const Rotation& rotation);
+    ~LogWriter();
+
+    bool        is_open() const { return m_path.isEmpty() || m_file.isOpen(); }
+    QString     path() const { return m_path; }
+
+    void        set_level(QtMsgType level) { m_level.store(severity(level), std::memory_order_relaxed); }
+    bool        is_enabled(QtMsgType type) const { return severity(type) >= m_level.load(std::memory_order_relaxed); }
+
+    // Never blocks on I/O
+    void        write(QtMsgType type, const QString& message);
+    // Blocks until everything queued so far is written (for fatal errors)
+    void        flush();
+
+    quint64     dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    static bool parse_level(const QString& name, QtMsgType& level);
+
+private:    // typedefs and enums
+    struct Node
+    {
+        std::atomic<Node*> next{nullptr};
+        qint64      stamp{0};
+        QtMsgType   type{QtInfoMsg};
+        QString     text;
+    };
+
+    // Queue depth past which new messages are dropped
+    static constexpr int max_pending{100000};
+    // Queue depth at which the writer is woken early
+    static constexpr int wake_pending{256};
+    // Longest a message waits to be written when the queue is quiet
+    static constexpr int flush_interval{100};  // milliseconds
+
+private:    // methods
+    static int  severity(QtMsgType type);
+
+    void        push(Node* node);
+    Node*       pop();
+
+    void        run();
+    void        drain();
+    void        rotate_if_needed();
+    void        rotate();
+
+private:    // data members
+    QString     m_path;
+    Rotation    m_rotation;
+
+    // Only the writer thread touches these once it is running
+    QFile       m_file;
+    qint64      m_opened{0};
+    qint64      m_last_second{-1};
+    QString     m_last_second_text;
+    quint64     m_reported{0};
+
+    // Vyukov MPSC queue
+    std::atomic<Node*> m_head;
+    Node*       m_tail;
+    Node        m_stub;
+
+    std::atomic<int> m_pending{0};
+    std::atomic<int> m_level;
+    std::atomic<quint64> m_dropped{0};
+    std::atomic<quint64> m_written{0};
+    std::atomic<quint64> m_queued{0};
+
+    std::atomic<bool> m_running{true};
+    std::mutex  m_wake_lock;
+    std::condition_variable m_wake;
+    std::thread m_thread;
+};
+
+using LogWriterPtr = QSharedPointer<LogWriter>;
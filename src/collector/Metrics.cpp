@@ -0,0 +1,114 @@
+#include <QTextStream>
+
+#include "Metrics.h"
+
+Histogram::Histogram(const QList<double>& bounds)
+{
+    for(auto bound : bounds)
+    {
+        if(m_bucket_count == max_buckets)
+            break;
+        m_bounds[static_cast<size_t>(m_bucket_count++)] = static_cast<qint64>(bound * 1e9);
+    }
+}
+
+const QList<double>& Histogram::latency_bounds()
+{
+    static const QList<double> bounds{ 0.00001, 0.000025, 0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 1.0 };
+    return bounds;
+}
+
+void Histogram::observe_ns(qint64 ns)
+{
+    // A dozen or so compares beats a binary search at this size
+    int index = 0;
+    while(index < m_bucket_count && ns > m_bounds[static_cast<size_t>(index)])
+        ++index;
+
+    m_buckets[static_cast<size_t>(index)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum_ns.fetch_add(static_cast<quint64>(qMax(qint64(0), ns)), std::memory_order_relaxed);
+}
+
+Metrics::~Metrics()
+{
+    foreach(const auto& entry, m_entries)
+    {
+        delete entry.counter;
+        delete entry.histogram;
+    }
+}
+
+Counter* Metrics::add_counter(const QString& name, const QString& help)
+{
+    Entry entry{Kind::Counter, name, help, new Counter(), nullptr, Sample()};
+    m_entries.append(entry);
+    return entry.counter;
+}
+
+Histogram* Metrics::add_histogram(const QString& name, const QString& help, const QList<double>& bounds)
+{
+    Entry entry{Kind::Histogram, name, help, nullptr, new Histogram(bounds), Sample()};
+    m_entries.append(entry);
+    return entry.histogram;
+}
+
+void Metrics::add_gauge(const QString& name, const QString& help, Sample sample)
+{
+    m_entries.append(Entry{Kind::Gauge, name, help, nullptr, nullptr, sample});
+}
+
+void Metrics::add_sampled_counter(const QString& name, const QString& help, Sample sample)
+{
+    m_entries.append(Entry{Kind::SampledCounter, name, help, nullptr, nullptr, sample});
+}
+
+QByteArray Metrics::exposition() const
+{
+    QByteArray text;
+    QTextStream out(&text);
+
+    foreach(const auto& entry, m_entries)
+    {
+        out << "# HELP " << entry.name << " " << entry.help << "\n";
+
+        switch(entry.kind)
+        {
+            case Kind::Counter:
+                out << "# TYPE " << entry.name << " counter\n";
+                out << entry.name << " " << entry.counter->value() << "\n";
+                break;
+
+            case Kind::SampledCounter:
+                out << "# TYPE " << entry.name << " counter\n";
+                out << entry.name << " " << QString::number(entry.sample(), 'g', 16) << "\n";
+                break;
+
+            case Kind::Gauge:
+                out << "# TYPE " << entry.name << " gauge\n";
+                out << entry.name << " " << QString::number(entry.sample(), 'g', 16) << "\n";
+                break;
+
+            case Kind::Histogram:
+            {
+                const auto* histogram = entry.histogram;
+                out << "# TYPE " << entry.name << " histogram\n";
+
+                quint64 cumulative{0};
+                for(int i = 0;i < histogram->bucket_count();++i)
+                {
+                    cumulative += histogram->bucket(i);
+                    out << entry.name << "_bucket{le=\"" << QString::number(histogram->bound(i), 'g', 6) << "\"} " << cumulative << "\n";
+                }
+                cumulative += histogram->bucket(histogram->bucket_count());
+                out << entry.name << "_bucket{le=\"+Inf\"} " << cumulative << "\n";
+                out << entry.name << "_sum " << QString::number(histogram->sum(), 'g', 12) << "\n";
+                out << entry.name << "_count " << histogram->count() << "\n";
+                break;
+            }
+        }
+    }
+
+    out.flush();
+    return text;
+}
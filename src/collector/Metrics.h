@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <functional>
+
+#include <QList>
+#include <QString>
+#include <QByteArray>
+#include <QSharedPointer>
+
+//---------------------------------------------------------------------------
+// Metrics
+//
+// Counters and latency histograms for each stage of the Collector pipeline,
+// rendered in the Prometheus text exposition format.
+//
+// Recording is a handful of relaxed atomic increments into fixed storage:
+// no locks, no allocation, and nothing for the hot path to wait on.  The
+// renderer reads the same atomics, so a scrape may see a histogram whose
+// buckets are a few observations ahead of its count, which Prometheus
+// tolerates.
+//---------------------------------------------------------------------------
+
+class Counter
+{
+public:
+    void        increment(quint64 by = 1) { m_value.fetch_add(by, std::memory_order_relaxed); }
+    quint64     value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<quint64> m_value{0};
+};
+
+class Histogram
+{
+public:
+    static constexpr int max_buckets{16};
+
+public:
+    // Upper bounds, in seconds, in increasing order
+    explicit Histogram(const QList<double>& bounds);
+
+    void        observe_ns(qint64 ns);
+
+    int         bucket_count() const { return m_bucket_count; }
+    double      bound(int bucket) const { return m_bounds[static_cast<size_t>(bucket)] / 1e9; }
+    quint64     bucket(int bucket) const { return m_buckets[static_cast<size_t>(bucket)].load(std::memory_order_relaxed); }
+    quint64     count() const { return m_count.load(std::memory_order_relaxed); }
+    double      sum() const { return m_sum_ns.load(std::memory_order_relaxed) / 1e9; }
+
+    // Latency buckets suited to work measured in microseconds to a second
+    static const QList<double>& latency_bounds();
+
+private:
+    std::array<qint64, max_buckets> m_bounds{};
+    int         m_bucket_count{0};
+
+    // Non-cumulative; the final slot counts observations above every bound
+    std::array<std::atomic<quint64>, max_buckets + 1> m_buckets{};
+    std::atomic<quint64> m_count{0};
+    std::atomic<quint64> m_sum_ns{0};
+};
+
+class Metrics
+{
+public:
+    using Sample = std::function<double()>;
+
+public:
+    Metrics() = default;
+    ~Metrics();
+
+    // Metrics live as long as the registry; the pointers returned are stable.
+    Counter*    add_counter(const QString& name, const QString& help);
+    Histogram*  add_histogram(const QString& name, const QString& help, const QList<double>& bounds = Histogram::latency_bounds());
+    // A value owned elsewhere, sampled at render time
+    void        add_gauge(const QString& name, const QString& help, Sample sample);
+    void        add_sampled_counter(const QString& name, const QString& help, Sample sample);
+
+    QByteArray  exposition() const;
+
+private:    // typedefs and enums
+    enum class Kind { Counter, Histogram, Gauge, SampledCounter };
+
+    struct Entry
+    {
+        Kind        kind;
+        QString     name;
+        QString     help;
+        Counter*    counter{nullptr};
+        Histogram*  histogram{nullptr};
+        Sample      sample;
+    };
+
+private:    // data members
+    QList<Entry> m_entries;
+};
+
+using MetricsPtr = QSharedPointer<Metrics>;
@@ -0,0 +1,89 @@
+#include <QTcpSocket>
+#include <QSaveFile>
+
+#include "MetricsServer.h"
+
+MetricsServer::MetricsServer(MetricsPtr metrics, QObject* parent)
+    : QObject(parent),
+      m_metrics(metrics)
+{
+    connect(&m_server, &QTcpServer::newConnection, this, &MetricsServer::slot_new_connection);
+    connect(&m_textfile_timer, &QTimer::timeout, this, &MetricsServer::slot_write_textfile);
+}
+
+bool MetricsServer::listen(const QHostAddress& address, quint16 port)
+{
+    return m_server.listen(address, port);
+}
+
+void MetricsServer::set_textfile(const QString& path, int interval)
+{
+    m_textfile = path;
+    m_textfile_timer.stop();
+
+    if(!m_textfile.isEmpty())
+    {
+        m_textfile_timer.setInterval(qMax(1, interval) * 1000);
+        m_textfile_timer.start();
+        slot_write_textfile();
+    }
+}
+
+void MetricsServer::slot_new_connection()
+{
+    while(m_server.hasPendingConnections())
+    {
+        auto* socket = m_server.nextPendingConnection();
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
+            // Wait for the end of the request headers
+            auto request = socket->peek(max_request);
+            if(!request.contains("\r\n\r\n") && !request.contains("\n\n"))
+            {
+                if(request.size() >= max_request)
+                    socket->abort();
+                return;
+            }
+            socket->readAll();
+
+            auto request_line = request.left(request.indexOf('\n')).trimmed().split(' ');
+            QByteArray status("200 OK");
+            QByteArray content_type("text/plain; version=0.0.4; charset=utf-8");
+            QByteArray body;
+
+            if(request_line.count() < 2 || request_line[0] != "GET")
+            {
+                status = "405 Method Not Allowed";
+                content_type = "text/plain";
+            }
+            else if(request_line[1] != "/metrics" && request_line[1] != "/")
+            {
+                status = "404 Not Found";
+                content_type = "text/plain";
+            }
+            else
+                body = m_metrics->exposition();
+
+            QByteArray response("HTTP/1.0 ");
+            response += status + "\r\n";
+            response += "Content-Type: " + content_type + "\r\n";
+            response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+            response += "Connection: close\r\n\r\n";
+            response += body;
+
+            socket->write(response);
+            socket->disconnectFromHost();
+        });
+    }
+}
+
+void MetricsServer::slot_write_textfile()
+{
+    // The textfile collector must never see a half-written file
+    QSaveFile file(m_textfile);
+    if(!file.open(QIODevice::WriteOnly))
+        return;
+
+    file.write(m_metrics->exposition());
+    file.commit();
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QTimer>
+#include <QObject>
+#include <QString>
+#include <QTcpServer>
+#include <QHostAddress>
+#include <QSharedPointer>
+
+#include "Metrics.h"
+
+//---------------------------------------------------------------------------
+// MetricsServer
+//
+// Publishes a Metrics registry for Prometheus: over a minimal HTTP endpoint
+// (GET /metrics), and/or by periodically rewriting a file for the
+// node_exporter textfile collector.  Scrapes are served on the event loop
+// and never touch the pipeline's hot path beyond reading its atomics.
+//---------------------------------------------------------------------------
+
+class MetricsServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MetricsServer(MetricsPtr metrics, QObject* parent = nullptr);
+
+    bool        listen(const QHostAddress& address, quint16 port);
+    QString     error_string() const { return m_server.errorString(); }
+
+    // Rewrite 'path' (atomically) every 'interval' seconds
+    void        set_textfile(const QString& path, int interval);
+
+private slots:
+    void        slot_new_connection();
+    void        slot_write_textfile();
+
+private:    // typedefs and enums
+    // Scrape requests are tiny; anything larger is not one
+    static constexpr int max_request{8192};
+
+private:    // data members
+    MetricsPtr  m_metrics;
+    QTcpServer  m_server;
+
+    QString     m_textfile;
+    QTimer      m_textfile_timer;
+};
+
+using MetricsServerPtr = QSharedPointer<MetricsServer>;
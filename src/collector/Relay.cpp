@@ -0,0 +1,251 @@
+#include <algorithm>
+#include <vector>
+#include <utility>
+
+#include <QSet>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "Relay.h"
+#include "Logging.h"
+#include "SharedTypes.h"
+
+// The same report, apart from when it was sent: Collectors restamp every
+// rebroadcast as it leaves
+static bool same_report(QByteArray first, QByteArray second)
+{
+    SharedTypes::stamp_sent(first, 0);
+    SharedTypes::stamp_sent(second, 0);
+    return first == second;
+}
+
+Relay::Relay(ReceiverPtr source, SenderPtr destination, QObject* parent)
+    : QObject(parent),
+      m_source(source),
+      m_destination(destination)
+{
+    connect(m_source.data(), &Receiver::signal_datagram_available, this, &Relay::slot_source_datagram);
+
+    m_flush_timer.setInterval(flush_interval);
+    connect(&m_flush_timer, &QTimer::timeout, this, &Relay::slot_flush);
+}
+
+void Relay::set_domain_rate(int per_second, int burst)
+{
+    m_domain_rate = qMax(1, per_second);
+    m_domain_burst = qMax(m_domain_rate, burst);
+    m_buckets.clear();
+}
+
+void Relay::slot_source_datagram(const QByteArray& datagram)
+{
+    auto doc{QJsonDocument::fromJson(datagram)};
+    if(doc.isNull())
+        return;
+
+    QJsonObject object = doc.object();
+
+    // A Domain going offline takes everything we know about it along
+    if(object.contains("domain_id") &&
+       SharedTypes::MsgText2Type.value(object["type"].toString()) == SharedTypes::MessageType::DomainOffline)
+    {
+        ++m_received;
+        forget_domain(object["domain_id"].toString().toULongLong());
+        m_destination->send_datagram(datagram);
+        ++m_forwarded;
+        return;
+    }
+
+    // Only Collector reports are relayed; Dashboards on the source ring
+    // are served by their own Collectors.
+    if(!object.contains("domain_id") || !object.contains("sensor_name"))
+        return;
+
+    ++m_received;
+
+    auto domain_id = object["domain_id"].toString().toULongLong();
+    auto key = QString("%1/%2").arg(object["domain_id"].toString(), object["sensor_name"].toString());
+    auto now = QDateTime::currentMSecsSinceEpoch();
+
+    auto& entry = m_entries[key];
+    entry.domain_id = domain_id;
+    entry.last_heard = now;
+
+    if(!entry.last_forwarded.isEmpty() && same_report(entry.last_forwarded, datagram))
+    {
+        // A periodic rewrite, or another Dashboard's initialize storm
+        ++m_duplicates;
+        m_pending[domain_id].remove(key);
+        return;
+    }
+
+    auto& pending = m_pending[domain_id];
+    if(pending.contains(key))
+        ++m_coalesced;
+
+    Pending report;
+    report.report = datagram;
+    report.offline = SharedTypes::MsgText2Type.value(object["type"].toString()) == SharedTypes::MessageType::Offline;
+    pending[key] = report;
+
+    if(m_entries.count() > m_max_sensors)
+        evict(now);
+
+    if(!m_flush_timer.isActive())
+        m_flush_timer.start();
+}
+
+Relay::Bucket& Relay::refill(quint64 domain_id, qint64 now)
+{
+    if(!m_buckets.contains(domain_id))
+    {
+        Bucket bucket;
+        bucket.tokens = m_domain_burst;
+        bucket.last_refill = now;
+        m_buckets[domain_id] = bucket;
+    }
+
+    auto& bucket = m_buckets[domain_id];
+    bucket.tokens = qMin(static_cast<double>(m_domain_burst), bucket.tokens + ((now - bucket.last_refill) * m_domain_rate) / 1000.0);
+    bucket.last_refill = now;
+    return bucket;
+}
+
+void Relay::slot_flush()
+{
+    auto now = QDateTime::currentMSecsSinceEpoch();
+
+    QList<QByteArray> batch;
+    QStringList keys;
+
+    auto domain_iter = m_pending.begin();
+    while(domain_iter != m_pending.end())
+    {
+        auto domain_id = domain_iter.key();
+        auto& pending = domain_iter.value();
+
+        auto& bucket = refill(domain_id, now);
+        auto report_iter = pending.begin();
+        while(report_iter != pending.end() && bucket.tokens >= 1.0)
+        {
+            const auto& key = report_iter.key();
+            const auto& report = report_iter.value();
+
+            batch.append(report.report);
+            keys.append(key);
+
+            // A Sensor that has gone offline has nothing left to remember
+            if(report.offline)
+                m_entries.remove(key);
+            else if(m_entries.contains(key))
+                m_entries[key].last_forwarded = report.report;
+
+            report_iter = pending.erase(report_iter);
+            bucket.tokens -= 1.0;
+        }
+
+        if(pending.isEmpty())
+            domain_iter = m_pending.erase(domain_iter);
+        else
+            ++domain_iter;
+    }
+
+    if(!batch.isEmpty())
+    {
+        m_destination->send_datagrams(batch, keys);
+        m_forwarded += static_cast<quint64>(batch.count());
+    }
+
+    if(m_pending.isEmpty())
+        m_flush_timer.stop();
+}
+
+void Relay::rebroadcast()
+{
+    QList<QByteArray> batch;
+    QStringList keys;
+
+    for(auto iter = m_entries.cbegin();iter != m_entries.cend();++iter)
+    {
+        if(iter.value().last_forwarded.isEmpty())
+            continue;
+
+        batch.append(iter.value().last_forwarded);
+        keys.append(iter.key());
+    }
+
+    if(!batch.isEmpty())
+        m_destination->send_datagrams(batch, keys);
+}
+
+void Relay::request_initialize(SenderPtr source)
+{
+    // Kept, so the request is not lost with the Sender before it drains
+    m_source_requests = source;
+
+    // We ask just as a Dashboard joining the source ring would
+    auto initialize = QString("{ \"dashboard_id\" : \"%1\", \"action\" : \"initialize\" }")
+        .arg(reinterpret_cast<qint64>(this));
+    m_source_requests->send_datagram(initialize.toUtf8());
+}
+
+void Relay::forget_domain(quint64 domain_id)
+{
+    m_pending.remove(domain_id);
+    m_buckets.remove(domain_id);
+
+    auto iter = m_entries.begin();
+    while(iter != m_entries.end())
+    {
+        if(iter.value().domain_id == domain_id)
+            iter = m_entries.erase(iter);
+        else
+            ++iter;
+    }
+}
+
+void Relay::evict(qint64 now)
+{
+    Q_UNUSED(now)
+
+    // Drop the least recently heard 5% in one pass, so we are not back
+    // here on the very next report.  Ranked, not cut off at an age, so
+    // Sensors heard in the same millisecond cannot take more with them.
+    std::vector<std::pair<qint64, QString>> ages;
+    ages.reserve(static_cast<size_t>(m_entries.count()));
+    for(auto iter = m_entries.cbegin();iter != m_entries.cend();++iter)
+        ages.emplace_back(iter.value().last_heard, iter.key());
+
+    auto count = qMax<size_t>(1, ages.size() / 20);
+    std::nth_element(ages.begin(), ages.begin() + static_cast<long>(count - 1), ages.end());
+
+    for(size_t index = 0;index < count;++index)
+    {
+        const auto& key = ages[index].second;
+        auto domain_id = m_entries.value(key).domain_id;
+        if(m_pending.contains(domain_id))
+        {
+            m_pending[domain_id].remove(key);
+            if(m_pending[domain_id].isEmpty())
+                m_pending.remove(domain_id);
+        }
+
+        m_entries.remove(key);
+        ++m_evicted;
+    }
+
+    // Buckets for Domains we no longer remember are just clutter
+    QSet<quint64> live_domains;
+    for(auto entry = m_entries.cbegin();entry != m_entries.cend();++entry)
+        live_domains.insert(entry.value().domain_id);
+
+    auto bucket = m_buckets.begin();
+    while(bucket != m_buckets.end())
+    {
+        if(!live_domains.contains(bucket.key()))
+            bucket = m_buckets.erase(bucket);
+        else
+            ++bucket;
+    }
+}
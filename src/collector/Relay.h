@@ -0,0 +1,111 @@
+#pragma once
+
+#include <QMap>
+#include <QHash>
+#include <QTimer>
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QSharedPointer>
+
+#include "Sender.h"
+#include "Receiver.h"
+
+//---------------------------------------------------------------------------
+// Relay
+//
+// Bridges one multicast ring to another (or to a unicast upstream), so
+// Dashboards can watch Domains outside their own subnet.
+//
+// Reports heard on the source ring are coalesced by (domain id, Sensor):
+// only the latest report for each Sensor waits to be forwarded, and a
+// report identical to the last one forwarded is dropped.  Pending reports
+// are released in batches on a short timer, subject to a per-Domain rate
+// cap, so one chatty Domain cannot crowd out the rest.  The last report for
+// every Sensor is kept (up to a fixed limit) so Dashboards joining the
+// destination ring can be initialized without disturbing the source ring.
+//---------------------------------------------------------------------------
+
+class Relay : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit Relay(ReceiverPtr source, SenderPtr destination, QObject* parent = nullptr);
+
+    // Reports per second, and the burst allowed above that, per Domain
+    void        set_domain_rate(int per_second, int burst);
+    // Most Sensors we will remember; the least recently heard are evicted past this
+    void        set_max_sensors(int max) { m_max_sensors = qMax(1, max); }
+
+    // Send the last known report of every Sensor to the destination
+    void        rebroadcast();
+    // Ask the Collectors on the source ring, through 'source', to send
+    // everything they have, so we do not start out knowing nothing
+    void        request_initialize(SenderPtr source);
+
+    quint64     received() const { return m_received; }
+    quint64     forwarded() const { return m_forwarded; }
+    quint64     coalesced() const { return m_coalesced; }
+    quint64     duplicates() const { return m_duplicates; }
+    quint64     evicted() const { return m_evicted; }
+
+private slots:
+    void        slot_source_datagram(const QByteArray& datagram);
+    void        slot_flush();
+
+private:    // typedefs and enums
+    struct Entry
+    {
+        quint64     domain_id{0};
+        QByteArray  last_forwarded;
+        qint64      last_heard{0};
+    };
+
+    struct Pending
+    {
+        QByteArray  report;
+        bool        offline{false};
+    };
+
+    struct Bucket
+    {
+        double      tokens{0.0};
+        qint64      last_refill{0};
+    };
+
+    using EntryMap = QHash<QString, Entry>;
+    using PendingMap = QMap<QString, Pending>;              // Sensor key -> latest report
+    using DomainPendingMap = QMap<quint64, PendingMap>;
+    using BucketMap = QHash<quint64, Bucket>;
+
+    static constexpr int flush_interval{100};   // milliseconds
+
+private:    // methods
+    Bucket&     refill(quint64 domain_id, qint64 now);
+    void        evict(qint64 now);
+    void        forget_domain(quint64 domain_id);
+
+private:    // data members
+    ReceiverPtr m_source;
+    SenderPtr   m_destination;
+    SenderPtr   m_source_requests;
+
+    EntryMap    m_entries;
+    DomainPendingMap m_pending;
+    BucketMap   m_buckets;
+
+    int         m_domain_rate{20};
+    int         m_domain_burst{100};
+    int         m_max_sensors{250000};
+
+    QTimer      m_flush_timer;
+
+    quint64     m_received{0};
+    quint64     m_forwarded{0};
+    quint64     m_coalesced{0};
+    quint64     m_duplicates{0};
+    quint64     m_evicted{0};
+};
+
+using RelayPtr = QSharedPointer<Relay>;
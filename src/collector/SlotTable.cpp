@@ -0,0 +1,88 @@
+#include <QFile>
+
+#include "SlotTable.h"
+#include "Logging.h"
+
+SlotTable::SlotTable(const QString& name, uint32_t slot_count, int scan_interval, QObject* parent)
+    : QObject(parent),
+      m_name(name)
+{
+    m_shm = dashd_shm_create(QFile::encodeName(m_name).constData(), slot_count);
+    if(!m_shm)
+    {
+        qCritical() << tr("Could not create shared-memory segment \"") << m_name << "\".";
+        return;
+    }
+
+    m_forwarded.resize(static_cast<int>(slot_count));
+
+    m_scanner = TimerPtr(new QTimer());
+    m_scanner->setTimerType(Qt::PreciseTimer);
+    m_scanner->setInterval(scan_interval);
+    connect(m_scanner.data(), &QTimer::timeout, this, &SlotTable::slot_scan);
+    m_scanner->start();
+}
+
+SlotTable::~SlotTable()
+{
+    if(m_scanner)
+        m_scanner->stop();
+
+    if(m_shm)
+    {
+        dashd_shm_close(m_shm);
+        dashd_shm_unlink(QFile::encodeName(m_name).constData());
+    }
+}
+
+void SlotTable::free_slot(uint32_t slot)
+{
+    m_forwarded[static_cast<int>(slot)] = Forwarded();
+    dashd_shm_free_slot(m_shm, slot);
+}
+
+void SlotTable::slot_scan()
+{
+    const auto slot_count = dashd_shm_slot_count(m_shm);
+    const auto words = (slot_count + 63) / 64;
+
+    for(uint32_t word = 0;word < words;++word)
+    {
+        auto dirty = dashd_shm_take_dirty(m_shm, word);
+        while(dirty)
+        {
+            const auto bit = static_cast<uint32_t>(__builtin_ctzll(dirty));
+            dirty &= dirty - 1;
+
+            const auto index = word * 64 + bit;
+            if(index >= slot_count)
+                continue;
+
+            struct dashd_shm_slot snapshot;
+            if(dashd_shm_read(m_shm, index, &snapshot) != 0)
+            {
+                // The writer is mid-update; look again on the next pass
+                dashd_shm_mark_dirty(m_shm, index);
+                continue;
+            }
+
+            if(!snapshot.in_use || snapshot.state == DASHD_STATE_UNDEFINED)
+                continue;
+
+            auto& last = m_forwarded[static_cast<int>(index)];
+            auto name = QString::fromUtf8(snapshot.name);
+            auto message = QString::fromUtf8(snapshot.message, static_cast<int>(snapshot.message_length));
+            auto message_hash = qHash(message);
+
+            if(last.state == snapshot.state && last.message_hash == message_hash && last.name == name)
+                continue;
+
+            last.state = snapshot.state;
+            last.message_hash = message_hash;
+            last.name = name;
+
+            emit signal_slot_changed(index, name, static_cast<SharedTypes::SensorState>(snapshot.state), message,
+                                     QDateTime::fromMSecsSinceEpoch(snapshot.updated));
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QTimer>
+#include <QDateTime>
+#include <QSharedPointer>
+
+#include "SharedTypes.h"
+#include "dashd_shm.h"
+
+//---------------------------------------------------------------------------
+// SlotTable
+//
+// Owns the shared-memory Sensor slot segment (see src/shm/dashd_shm.h) and
+// scans its dirty bitmap on a short timer.  Slots whose state or message
+// differ from what we last forwarded are reported; rewrites of an identical
+// state are absorbed here.
+//---------------------------------------------------------------------------
+
+class SlotTable : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SlotTable(const QString& name, uint32_t slot_count, int scan_interval, QObject* parent = nullptr);
+    ~SlotTable();
+
+    bool        is_open() const { return m_shm != nullptr; }
+    QString     name() const { return m_name; }
+
+    // Return a slot to the free pool once its Sensor has been reported offline
+    void        free_slot(uint32_t slot);
+
+signals:
+    void        signal_slot_changed(uint32_t slot, const QString& sensor_name, SharedTypes::SensorState state, const QString& message, const QDateTime& updated);
+
+private slots:
+    void        slot_scan();
+
+private:    // typedefs and enums
+    struct Forwarded
+    {
+        uint32_t    state{DASHD_STATE_UNDEFINED};
+        uint        message_hash{0};
+        QString     name;
+    };
+
+    using TimerPtr = QSharedPointer<QTimer>;
+
+private:    // data members
+    QString     m_name;
+    dashd_shm_t* m_shm{nullptr};
+
+    QVector<Forwarded> m_forwarded;
+
+    TimerPtr    m_scanner;
+};
+
+using SlotTablePtr = QSharedPointer<SlotTable>;
@@ -18,13 +18,39 @@ win32 {
     DEFINES += QT_WIN
 }
 
-INCLUDEPATH += ../common ../common/network
+# Trace spans (see common/Trace.h) are compiled in with: qmake "DEFINES+=DASHD_TRACE"
+
+# Codec compresses datagrams with zlib: the system's on Unix, and on
+# Windows the copy built into QtCore
+unix: LIBS += -lz
+win32: QT += zlib-private
+
+INCLUDEPATH += ../common ../common/network ../shm
+
+unix:!mac {
+    LIBS += -lrt
+
+    # Sensors on this host can push reports over a Unix datagram socket,
+    # or write them into a POSIX shared-memory slot table
+    SOURCES += LocalReceiver.cpp SlotTable.cpp ../shm/dashd_shm.c
+    HEADERS += LocalReceiver.h SlotTable.h ../shm/dashd_shm.h
+}
 
 SOURCES += \
+    ../common/Journal.cpp \
     ../common/SharedTypes.cpp \
+    ../common/Trace.cpp \
+    ../common/network/Capture.cpp \
+    ../common/network/Codec.cpp \
     ../common/network/Receiver.cpp \
     ../common/network/Sender.cpp \
+    ../common/network/Subscription.cpp \
     Collector.cpp \
+    FlapDamper.cpp \
+    LogWriter.cpp \
+    Metrics.cpp \
+    MetricsServer.cpp \
+    Relay.cpp \
     main.cpp
 
 # Default rules for deployment.
@@ -33,8 +59,18 @@ else: unix:!android: target.path = /opt/$${TARGET}/bin
 !isEmpty(target.path): INSTALLS += target
 
 HEADERS += \
+    ../common/Journal.h \
     ../common/SharedTypes.h \
+    ../common/Trace.h \
+    ../common/network/Capture.h \
+    ../common/network/Codec.h \
     ../common/network/Receiver.h \
     ../common/network/Sender.h \
+    ../common/network/Subscription.h \
+    FlapDamper.h \
     Logging.h \
+    LogWriter.h \
+    Metrics.h \
+    MetricsServer.h \
+    Relay.h \
     Collector.h
@@ -0,0 +1,369 @@
+#include <algorithm>
+#include <cstring>
+
+#include <QDir>
+#include <QObject>
+#include <QDateTime>
+#include <QTextStream>
+
+#include "Journal.h"
+
+static_assert(sizeof(Journal::Record) == JournalFormat::record_size, "Journal records must stay 32 bytes");
+
+Journal::Journal(const QString& path, quint32 segment_records, int max_segments)
+    : m_path(path),
+      m_segment_records(qMax<quint32>(segment_records, 16)),
+      m_max_segments(qMax(max_segments, 0))
+{
+}
+
+Journal::~Journal()
+{
+    close();
+}
+
+bool Journal::open(bool read_only)
+{
+    close();
+
+    m_read_only = read_only;
+
+    QDir dir(m_path);
+    if(!dir.exists() && (read_only || !dir.mkpath(".")))
+    {
+        m_error = QObject::tr(read_only ? "\"%1\" does not exist" : "could not create \"%1\"").arg(m_path);
+        return false;
+    }
+
+    // File names sort in time order (see map_segment())
+    auto entries = dir.entryList(QStringList() << QString("*%1").arg(JournalFormat::suffix), QDir::Files, QDir::Name);
+    foreach(const QString& entry, entries)
+    {
+        auto file_name = dir.filePath(entry);
+
+        Header header;
+        if(!read_header(file_name, header))
+            continue;
+
+        Segment segment;
+        segment.file_name = file_name;
+        segment.first = static_cast<qint64>(header.first_timestamp);
+        segment.last = static_cast<qint64>(header.last_timestamp);
+        segment.count = header.count;
+        m_segments.append(segment);
+    }
+
+    // Carry on filling the newest segment if it has room
+    if(!read_only && !m_segments.isEmpty())
+    {
+        Header header;
+        const auto& last = m_segments.last();
+        if(read_header(last.file_name, header) && header.count < header.capacity)
+            map_segment(last.file_name, false, 0);
+    }
+
+    load_names();
+
+    if(read_only)
+    {
+        m_is_open = true;
+        return true;
+    }
+
+    m_names_file.setFileName(dir.filePath(JournalFormat::names_file));
+    if(!m_names_file.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+        m_error = QObject::tr("could not open \"%1\"").arg(m_names_file.fileName());
+        unmap_segment();
+        m_segments.clear();
+        return false;
+    }
+
+    m_is_open = true;
+    return true;
+}
+
+void Journal::close()
+{
+    unmap_segment();
+    m_names_file.close();
+    m_segments.clear();
+    m_names.clear();
+    m_is_open = false;
+}
+
+bool Journal::append(const QString& sensor_name, quint8 old_state, quint8 new_state, const QString& message)
+{
+    auto id = sensor_id(sensor_name);
+    if(!m_names.contains(id))
+        remember_name(id, sensor_name);
+
+    return append(id, old_state, new_state, message_hash(message), QDateTime::currentMSecsSinceEpoch());
+}
+
+bool Journal::append(quint64 sensor_id, quint8 old_state, quint8 new_state, quint32 message_hash, qint64 timestamp)
+{
+    if(!m_is_open || m_read_only)
+        return false;
+
+    // Keep time moving forward, so the index stays searchable even if the
+    // wall clock is stepped back
+    if(!m_segments.isEmpty())
+        timestamp = qMax(timestamp, m_segments.last().last);
+
+    if(!m_header || m_header->count == m_header->capacity)
+    {
+        unmap_segment();
+
+        // A whole segment filled within one millisecond would reuse a
+        // name; nudging time forward keeps names unique and in order
+        auto segment_name = [this](qint64 t) {
+            return QDir(m_path).filePath(QString("%1%2").arg(t, 13, 10, QChar('0')).arg(JournalFormat::suffix));
+        };
+        while(QFile::exists(segment_name(timestamp)))
+            ++timestamp;
+        auto file_name = segment_name(timestamp);
+
+        if(!map_segment(file_name, true, timestamp))
+            return false;
+
+        trim_segments();
+    }
+
+    auto& record = m_records[m_header->count];
+    record.timestamp = static_cast<quint64>(timestamp);
+    record.sensor_id = sensor_id;
+    record.message_hash = message_hash;
+    record.old_state = old_state;
+    record.new_state = new_state;
+    memset(record.reserved, 0, sizeof(record.reserved));
+
+    // The record is complete before the count says it exists
+    m_header->last_timestamp = static_cast<quint64>(timestamp);
+    ++m_header->count;
+
+    auto& segment = m_segments.last();
+    segment.last = timestamp;
+    segment.count = m_header->count;
+
+    return true;
+}
+
+QVector<Journal::Record> Journal::query(qint64 from, qint64 to, quint64 sensor_id) const
+{
+    QVector<Record> results;
+    if(from >= to)
+        return results;
+
+    // First segment that might hold 'from': the last one starting at or
+    // before it
+    auto begin = std::upper_bound(m_segments.begin(), m_segments.end(), from,
+                                  [](qint64 t, const Segment& s) { return t < s.first; });
+    if(begin != m_segments.begin())
+        --begin;
+
+    for(auto s = begin;s != m_segments.end() && s->first < to;++s)
+    {
+        if(s->count == 0 || s->last < from)
+            continue;
+
+        if(m_header && s == m_segments.end() - 1)
+        {
+            scan(m_header, m_records, from, to, sensor_id, results);
+            continue;
+        }
+
+        QFile file(s->file_name);
+        if(!file.open(QIODevice::ReadOnly))
+            continue;
+
+        auto* map = file.map(0, file.size());
+        if(!map)
+            continue;
+
+        auto* header = reinterpret_cast<const Header*>(map);
+        auto* records = reinterpret_cast<const Record*>(map + JournalFormat::header_size);
+        if(file.size() >= JournalFormat::header_size + static_cast<qint64>(header->count) * JournalFormat::record_size)
+            scan(header, records, from, to, sensor_id, results);
+
+        file.unmap(map);
+    }
+
+    return results;
+}
+
+quint64 Journal::records() const
+{
+    quint64 total{0};
+    foreach(const Segment& segment, m_segments)
+        total += segment.count;
+    return total;
+}
+
+quint64 Journal::sensor_id(const QString& sensor_name)
+{
+    // FNV-1a: stable across runs and builds, unlike qHash()
+    quint64 hash{14695981039346656037ULL};
+    auto utf8 = sensor_name.toUtf8();
+    for(auto c : utf8)
+    {
+        hash ^= static_cast<quint8>(c);
+        hash *= 1099511628211ULL;
+    }
+    // Zero means "every Sensor" to query()
+    return hash ? hash : 1;
+}
+
+quint32 Journal::message_hash(const QString& message)
+{
+    if(message.isEmpty())
+        return 0;
+
+    quint32 hash{2166136261U};
+    auto utf8 = message.toUtf8();
+    for(auto c : utf8)
+    {
+        hash ^= static_cast<quint8>(c);
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+bool Journal::map_segment(const QString& file_name, bool create, qint64 first)
+{
+    m_file.setFileName(file_name);
+    if(!m_file.open(QIODevice::ReadWrite))
+    {
+        m_error = QObject::tr("could not open \"%1\"").arg(file_name);
+        return false;
+    }
+
+    quint32 capacity = m_segment_records;
+    if(!create)
+    {
+        Header header;
+        m_file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        capacity = header.capacity;
+    }
+
+    auto size = JournalFormat::header_size + static_cast<qint64>(capacity) * JournalFormat::record_size;
+    if(create && !m_file.resize(size))
+    {
+        m_error = QObject::tr("could not allocate \"%1\"").arg(file_name);
+        m_file.close();
+        m_file.remove();
+        return false;
+    }
+
+    auto* map = m_file.map(0, size);
+    if(!map)
+    {
+        m_error = QObject::tr("could not map \"%1\"").arg(file_name);
+        m_file.close();
+        return false;
+    }
+
+    m_header = reinterpret_cast<Header*>(map);
+    m_records = reinterpret_cast<Record*>(map + JournalFormat::header_size);
+
+    if(create)
+    {
+        memset(m_header, 0, sizeof(Header));
+        memcpy(m_header->magic, JournalFormat::magic, JournalFormat::magic_size);
+        m_header->version = JournalFormat::version;
+        m_header->record_size = JournalFormat::record_size;
+        m_header->capacity = capacity;
+        m_header->first_timestamp = static_cast<quint64>(first);
+        m_header->last_timestamp = static_cast<quint64>(first);
+
+        Segment segment;
+        segment.file_name = file_name;
+        segment.first = first;
+        segment.last = first;
+        m_segments.append(segment);
+    }
+
+    return true;
+}
+
+void Journal::unmap_segment()
+{
+    if(m_header)
+        m_file.unmap(reinterpret_cast<uchar*>(m_header));
+    m_header = nullptr;
+    m_records = nullptr;
+    m_file.close();
+}
+
+void Journal::trim_segments()
+{
+    if(m_max_segments == 0)
+        return;
+
+    while(m_segments.count() > m_max_segments)
+    {
+        QFile::remove(m_segments.first().file_name);
+        m_segments.removeFirst();
+    }
+}
+
+void Journal::load_names()
+{
+    QFile file(QDir(m_path).filePath(JournalFormat::names_file));
+    if(!file.open(QIODevice::ReadOnly))
+        return;
+
+    QTextStream in(&file);
+    in.setCodec("UTF-8");
+    while(!in.atEnd())
+    {
+        auto line = in.readLine();
+        auto tab = line.indexOf('\t');
+        if(tab <= 0)
+            continue;
+
+        bool ok;
+        auto id = line.left(tab).toULongLong(&ok, 16);
+        if(ok)
+            m_names[id] = line.mid(tab + 1);
+    }
+}
+
+void Journal::remember_name(quint64 id, const QString& sensor_name)
+{
+    m_names[id] = sensor_name;
+
+    auto line = QString("%1\t%2\n").arg(id, 16, 16, QChar('0')).arg(sensor_name).toUtf8();
+    m_names_file.write(line);
+    m_names_file.flush();
+}
+
+bool Journal::read_header(const QString& file_name, Header& header)
+{
+    QFile file(file_name);
+    if(!file.open(QIODevice::ReadOnly))
+        return false;
+
+    if(file.read(reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header))
+        return false;
+
+    return !memcmp(header.magic, JournalFormat::magic, JournalFormat::magic_size) &&
+           header.version == JournalFormat::version &&
+           header.record_size == JournalFormat::record_size &&
+           header.count <= header.capacity &&
+           file.size() >= JournalFormat::header_size + static_cast<qint64>(header.capacity) * JournalFormat::record_size;
+}
+
+void Journal::scan(const Header* header, const Record* records, qint64 from, qint64 to,
+                   quint64 sensor_id, QVector<Record>& results)
+{
+    auto* end = records + header->count;
+    auto* r = std::lower_bound(records, end, static_cast<quint64>(from),
+                               [](const Record& record, quint64 t) { return record.timestamp < t; });
+
+    for(;r != end && r->timestamp < static_cast<quint64>(to);++r)
+    {
+        if(!sensor_id || r->sensor_id == sensor_id)
+            results.append(*r);
+    }
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <QFile>
+#include <QHash>
+#include <QVector>
+#include <QString>
+#include <QSharedPointer>
+
+//---------------------------------------------------------------------------
+// Journal
+//
+// An append-only history of every Sensor state transition a Collector has
+// seen, kept in a folder of memory-mapped segment files.
+//
+//   segment header: "DASHDJNL" version (u32) record size (u32) capacity
+//                   (u32) count (u32) first and last timestamp (u64 each),
+//                   padded to 64 bytes
+//   each record:    timestamp (u64, milliseconds since the epoch) sensor
+//                   id (u64) message hash (u32) old state (u8) new state
+//                   (u8), padded to 32 bytes
+//
+// Segments are preallocated and records are fixed size, so appending is a
+// copy into the mapping; nothing is synced per event (the kernel writes
+// the pages back, so only a crash of the host itself can lose the tail).
+// Integers are in host byte order.
+//
+// Timestamps never decrease, within a segment or from one segment to the
+// next, and each segment's file name is its first timestamp.  The segment
+// table is therefore a time index: a range query binary-searches the
+// table, then the records of each segment it overlaps.
+//
+// Sensor ids are a hash of the Sensor name; the names behind them are
+// kept alongside the segments in "sensors.names".
+//---------------------------------------------------------------------------
+
+class Journal
+{
+public:
+    struct Record
+    {
+        quint64     timestamp;
+        quint64     sensor_id;
+        quint32     message_hash;
+        quint8      old_state;
+        quint8      new_state;
+        quint8      reserved[10];
+    };
+
+public:
+    // 'segment_records' is only used for new segments; 'max_segments' of
+    // zero keeps everything
+    Journal(const QString& path, quint32 segment_records = default_segment_records, int max_segments = 0);
+    ~Journal();
+
+    // A read-only journal can be queried while a Collector appends to it
+    bool        open(bool read_only = false);
+    void        close();
+    bool        is_open() const { return m_is_open; }
+    QString     error_string() const { return m_error; }
+
+    QString     path() const { return m_path; }
+
+    bool        append(const QString& sensor_name, quint8 old_state, quint8 new_state, const QString& message);
+    bool        append(quint64 sensor_id, quint8 old_state, quint8 new_state, quint32 message_hash, qint64 timestamp);
+
+    // Records with from <= timestamp < to, oldest first ('sensor_id' of
+    // zero matches every Sensor)
+    QVector<Record> query(qint64 from, qint64 to, quint64 sensor_id = 0) const;
+
+    quint64     records() const;
+    int         segments() const { return m_segments.count(); }
+
+    QString     sensor_name(quint64 sensor_id) const { return m_names.value(sensor_id); }
+
+    static quint64 sensor_id(const QString& sensor_name);
+    static quint32 message_hash(const QString& message);
+
+    static constexpr quint32 default_segment_records{65536};
+
+private:    // typedefs and enums
+    struct Header
+    {
+        char        magic[8];
+        quint32     version;
+        quint32     record_size;
+        quint32     capacity;
+        quint32     count;
+        quint64     first_timestamp;
+        quint64     last_timestamp;
+        quint8      reserved[24];
+    };
+
+    struct Segment
+    {
+        QString     file_name;
+        qint64      first{0};
+        qint64      last{0};
+        quint32     count{0};
+    };
+
+    using SegmentList = QVector<Segment>;
+    using NameMap = QHash<quint64, QString>;
+
+private:    // methods
+    bool        map_segment(const QString& file_name, bool create, qint64 first);
+    void        unmap_segment();
+    void        trim_segments();
+    void        load_names();
+    void        remember_name(quint64 id, const QString& sensor_name);
+
+    static bool read_header(const QString& file_name, Header& header);
+    static void scan(const Header* header, const Record* records, qint64 from, qint64 to,
+                     quint64 sensor_id, QVector<Record>& results);
+
+private:    // data members
+    QString     m_path;
+    quint32     m_segment_records{default_segment_records};
+    int         m_max_segments{0};
+
+    bool        m_is_open{false};
+    bool        m_read_only{false};
+    QString     m_error;
+
+    SegmentList m_segments;
+
+    // The segment being appended to
+    QFile       m_file;
+    Header*     m_header{nullptr};
+    Record*     m_records{nullptr};
+
+    NameMap     m_names;
+    QFile       m_names_file;
+};
+
+using JournalPtr = QSharedPointer<Journal>;
+
+namespace JournalFormat
+{
+    constexpr char magic[] = "DASHDJNL";
+    constexpr int magic_size{8};
+    constexpr quint32 version{1};
+    constexpr int header_size{64};
+    constexpr int record_size{32};
+    constexpr const char* names_file{"sensors.names"};
+    constexpr const char* suffix{".journal"};
+}
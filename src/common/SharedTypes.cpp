@@ -1,8 +1,12 @@
+#include <QUrl>
+#include <QDateTime>
+
 #include "SharedTypes.h"
 
 SharedTypes::Type2TextMap SharedTypes::MsgType2Text = {
     { SharedTypes::MessageType::Sensor, "sensor" },
     { SharedTypes::MessageType::Offline, "offline" },
+    { SharedTypes::MessageType::DomainOffline, "domain_offline" },
     { SharedTypes::MessageType::Warning, "warning" },
     { SharedTypes::MessageType::Error, "error" },
 };
@@ -10,6 +14,7 @@ SharedTypes::Type2TextMap SharedTypes::MsgType2Text = {
 SharedTypes::Text2TypeMap SharedTypes::MsgText2Type = {
     { "sensor", SharedTypes::MessageType::Sensor },
     { "offline", SharedTypes::MessageType::Offline },
+    { "domain_offline", SharedTypes::MessageType::DomainOffline },
     { "warning", SharedTypes::MessageType::Warning },
     { "error", SharedTypes::MessageType::Error },
 };
@@ -34,3 +39,85 @@ SharedTypes::Text2StateMap SharedTypes::MsgText2State = {
 
 const char* SharedTypes::MULTICAST_IPV4{"239.255.77.15"};
 const char* SharedTypes::MULTICAST_IPV6{"ff12::1870"};
+
+QString SharedTypes::format_sensor_report(std::uint64_t domain_id, const QString& domain_name, qint64 updated,
+                                          const QString& sensor_name, const QString& sensor_state, const QString& sensor_message)
+{
+    return QString("{ \"domain_id\" : \"%1\", \"domain_name\" : \"%2\", "
+                   " \"type\" : \"%3\", "
+                   " \"updated\" : \"%4\", \"sent\" : \"%5\", "
+                   " \"sensor_name\" : \"%6\", \"sensor_state\" : \"%7\", "
+                   " \"sensor_message\" : \"%8\" }")
+        .arg(domain_id)
+        .arg(QUrl::toPercentEncoding(domain_name),
+            MsgType2Text[MessageType::Sensor],
+            QString::number(updated),
+            QString::number(QDateTime::currentMSecsSinceEpoch()),
+            QUrl::toPercentEncoding(sensor_name), sensor_state,
+            QUrl::toPercentEncoding(sensor_message));
+}
+
+bool SharedTypes::stamp_sent(QByteArray& report, qint64 when)
+{
+    static const QByteArray field("\"sent\" : \"");
+
+    auto start = report.indexOf(field);
+    if(start < 0)
+        return false;
+
+    start += field.size();
+    auto end = report.indexOf('"', start);
+    if(end < 0)
+        return false;
+
+    report.replace(start, end - start, QByteArray::number(when));
+    return true;
+}
+
+QString SharedTypes::format_offline_report(std::uint64_t domain_id, const QString& domain_name, const QString& sensor_name)
+{
+    return QString("{ \"domain_id\" : \"%1\", \"domain_name\" : \"%2\","
+                   " \"type\" : \"%3\","
+                   " \"sensor_name\" : \"%4\" }")
+        .arg(domain_id)
+        .arg(QUrl::toPercentEncoding(domain_name),
+             MsgType2Text[MessageType::Offline],
+             QUrl::toPercentEncoding(sensor_name));
+}
+
+QString SharedTypes::format_domain_offline_report(std::uint64_t domain_id, const QString& domain_name)
+{
+    return QString("{ \"domain_id\" : \"%1\", \"domain_name\" : \"%2\","
+                   " \"type\" : \"%3\" }")
+        .arg(domain_id)
+        .arg(QUrl::toPercentEncoding(domain_name),
+             MsgType2Text[MessageType::DomainOffline]);
+}
+
+static quint32 topic_hash(const QString& topic)
+{
+    // FNV-1a
+    quint32 hash = 2166136261u;
+    foreach(auto byte, topic.toLower().toUtf8())
+    {
+        hash ^= static_cast<quint8>(byte);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+QString SharedTypes::topic_group_ipv4(const QString& topic)
+{
+    // Within the same local scope (239.255/16) as the default group, but never it
+    auto hash = topic_hash(topic);
+    auto group = QString("239.255.%1.%2").arg((hash >> 8) & 0xFF).arg(hash & 0xFF);
+    if(group == MULTICAST_IPV4)
+        group = QString("239.255.%1.%2").arg((hash >> 24) & 0xFF).arg((hash >> 16) & 0xFF);
+    return group;
+}
+
+QString SharedTypes::topic_group_ipv6(const QString& topic)
+{
+    auto hash = topic_hash(topic);
+    return QString("ff12::d:%1:%2").arg((hash >> 16) & 0xFFFF, 0, 16).arg(hash & 0xFFFF, 0, 16);
+}
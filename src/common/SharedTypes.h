@@ -2,6 +2,7 @@
 
 #include <QMap>
 #include <QString>
+#include <QByteArray>
 
 constexpr int major = 0;
 constexpr int minor = 1;
@@ -22,6 +23,7 @@ public:    // typedefs and enums
     enum class MessageType {
         Sensor,     // Sensor data
         Offline,    // Informational: Sensor has gone offline
+        DomainOffline,  // Informational: every Sensor in the Domain has gone offline
         Warning,
         Error
     };
@@ -46,4 +48,21 @@ public:    // typedefs and enums
 
     static State2TextMap MsgState2Text;
     static Text2StateMap MsgText2State;
+
+public:     // methods
+    // The wire format of the reports a Collector sends to the multicast group.
+    // Sensor reports are stamped with the time they were formatted ("sent"),
+    // which the Sender restamps as they actually leave (see stamp_sent).
+    static QString  format_sensor_report(std::uint64_t domain_id, const QString& domain_name, qint64 updated,
+                                         const QString& sensor_name, const QString& sensor_state, const QString& sensor_message);
+    static QString  format_offline_report(std::uint64_t domain_id, const QString& domain_name, const QString& sensor_name);
+    static QString  format_domain_offline_report(std::uint64_t domain_id, const QString& domain_name);
+    // Rewrite the "sent" time of a formatted report in place; false if it has none
+    static bool     stamp_sent(QByteArray& report, qint64 when);
+
+    // The multicast groups a topic (e.g., a tenant or team name) publishes
+    // to, so Collectors and Dashboards agree on them from the name alone.
+    // Topics differing only in case share groups.
+    static QString  topic_group_ipv4(const QString& topic);
+    static QString  topic_group_ipv6(const QString& topic);
 };
@@ -0,0 +1,183 @@
+#include "Trace.h"
+
+#ifdef DASHD_TRACE
+
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#ifndef QT_WIN
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#endif
+
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+#include <QCoreApplication>
+
+namespace
+{
+    // One per thread; written only by its owner, read by dump()
+    struct Ring
+    {
+        std::int64_t    thread_id{0};
+        std::atomic<std::uint64_t> head{0};
+        Trace::Event    events[Trace::ring_size];
+    };
+
+    std::mutex& registry_lock()
+    {
+        static std::mutex lock;
+        return lock;
+    }
+
+    std::vector<Ring*>& registry()
+    {
+        // Rings outlive their threads so a dump can still read them
+        static std::vector<Ring*> rings;
+        return rings;
+    }
+
+    Ring* this_thread_ring()
+    {
+        thread_local Ring* ring = nullptr;
+        if(!ring)
+        {
+            ring = new Ring();
+
+            std::lock_guard<std::mutex> guard(registry_lock());
+            ring->thread_id = static_cast<std::int64_t>(registry().size()) + 1;
+            registry().push_back(ring);
+        }
+        return ring;
+    }
+
+    int signal_fds[2]{-1, -1};
+
+#ifndef QT_WIN
+    void signal_handler(int)
+    {
+        char byte{1};
+        auto written = ::write(signal_fds[0], &byte, sizeof(byte));
+        Q_UNUSED(written)
+    }
+#endif
+
+    QString json_escape(const char* text)
+    {
+        QString escaped(text);
+        escaped.replace('\\', "\\\\");
+        escaped.replace('"', "\\\"");
+        return escaped;
+    }
+}
+
+std::int64_t Trace::now_us()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void Trace::record(const char* name, std::int64_t begin_us, std::int64_t end_us)
+{
+    auto* ring = this_thread_ring();
+    auto head = ring->head.load(std::memory_order_relaxed);
+
+    auto& event = ring->events[head % ring_size];
+    event.name = name;
+    event.begin_us = begin_us;
+    event.duration_us = end_us - begin_us;
+
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+bool Trace::dump(const QString& path)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    QTextStream out(&file);
+    out << "{\"traceEvents\":[\n";
+
+    const auto pid = static_cast<qint64>(QCoreApplication::applicationPid());
+    bool first = true;
+
+    std::lock_guard<std::mutex> guard(registry_lock());
+    for(auto* ring : registry())
+    {
+        // Events being overwritten while we read may come out torn;
+        // that is the price of a lock-free writer.
+        auto head = ring->head.load(std::memory_order_acquire);
+        auto begin = head > static_cast<std::uint64_t>(ring_size) ? head - ring_size : 0;
+
+        for(auto i = begin;i < head;++i)
+        {
+            const auto& event = ring->events[i % ring_size];
+            if(!event.name)
+                continue;
+
+            out << (first ? "" : ",\n")
+                << "{\"name\":\"" << json_escape(event.name) << "\",\"ph\":\"X\""
+                << ",\"ts\":" << event.begin_us << ",\"dur\":" << event.duration_us
+                << ",\"pid\":" << pid << ",\"tid\":" << ring->thread_id << "}";
+            first = false;
+        }
+    }
+
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return true;
+}
+
+void Trace::install_dump_signal(const QString& directory, QObject* parent)
+{
+#ifdef QT_WIN
+    // No SIGUSR1 here; call Trace::dump() directly instead
+    Q_UNUSED(directory)
+    Q_UNUSED(parent)
+#else
+    if(signal_fds[0] >= 0)
+        return;
+
+    if(::socketpair(AF_UNIX, SOCK_STREAM, 0, signal_fds) != 0)
+        return;
+
+    new TraceDumper(signal_fds[1], directory, parent);
+
+    struct sigaction sa;
+    sa.sa_handler = signal_handler;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &sa, nullptr);
+#endif
+}
+
+TraceDumper::TraceDumper(int read_fd, const QString& directory, QObject* parent)
+    : QObject(parent),
+      m_read_fd(read_fd),
+      m_directory(directory),
+      m_notifier(read_fd, QSocketNotifier::Read)
+{
+    connect(&m_notifier, &QSocketNotifier::activated, this, &TraceDumper::slot_signal);
+}
+
+void TraceDumper::slot_signal()
+{
+#ifndef QT_WIN
+    char byte;
+    auto count = ::read(m_read_fd, &byte, sizeof(byte));
+    Q_UNUSED(count)
+#endif
+
+    auto name = QCoreApplication::applicationName().simplified().replace(' ', '_').remove('\'');
+    auto path = QDir(m_directory).absoluteFilePath(QString("%1-%2-%3.trace.json")
+                    .arg(name).arg(QCoreApplication::applicationPid()).arg(++m_dumps));
+    if(Trace::dump(path))
+        qInfo("Trace written to %s", qUtf8Printable(path));
+    else
+        qWarning("Could not write trace to %s", qUtf8Printable(path));
+}
+
+#endif
@@ -0,0 +1,100 @@
+#pragma once
+
+//---------------------------------------------------------------------------
+// Trace
+//
+// Compile-time removable trace spans for the Collector and Dashboard
+// pipelines.  Build with DASHD_TRACE defined (qmake "DEFINES+=DASHD_TRACE")
+// to enable them; otherwise every TRACE_ macro expands to nothing.
+//
+//   TRACE_SPAN("process_sensor_update");           // the enclosing scope
+//   TRACE_SPAN_SINCE("file_write", stamp_us);      // from an earlier wall-clock time to now
+//
+// Each thread records into its own fixed ring of events, so recording is a
+// few stores and a release increment with no locks.  When the ring wraps,
+// the oldest events are overwritten.  Trace::install_dump_signal() writes
+// every thread's ring as Chrome trace JSON (chrome://tracing, Perfetto)
+// when the process receives SIGUSR1.  Timestamps are wall-clock
+// microseconds, so traces from a Collector and a Dashboard line up.
+//---------------------------------------------------------------------------
+
+#ifdef DASHD_TRACE
+
+#include <atomic>
+#include <cstdint>
+
+#include <QObject>
+#include <QString>
+#include <QSocketNotifier>
+
+class Trace
+{
+public:
+    struct Event
+    {
+        const char* name{nullptr};      // must be a string literal
+        std::int64_t begin_us{0};
+        std::int64_t duration_us{0};
+    };
+
+    // Events kept per thread
+    static constexpr int ring_size{1 << 14};
+
+public:
+    static std::int64_t now_us();
+    static void record(const char* name, std::int64_t begin_us, std::int64_t end_us);
+
+    // Write every thread's events to 'path' as Chrome trace JSON
+    static bool dump(const QString& path);
+
+    // Dump to <directory>/<process>-<pid>-<n>.trace.json on SIGUSR1
+    static void install_dump_signal(const QString& directory, QObject* parent);
+};
+
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char* name) : m_name(name), m_begin(Trace::now_us()) {}
+    TraceSpan(const char* name, std::int64_t begin_us) : m_name(name), m_begin(begin_us) {}
+    ~TraceSpan() { Trace::record(m_name, m_begin, Trace::now_us()); }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char*     m_name;
+    std::int64_t    m_begin;
+};
+
+// Turns SIGUSR1 into a dump on the event loop (via a self-pipe), since
+// almost nothing is safe to do inside a signal handler.
+class TraceDumper : public QObject
+{
+    Q_OBJECT
+
+public:
+    TraceDumper(int read_fd, const QString& directory, QObject* parent);
+
+private slots:
+    void        slot_signal();
+
+private:
+    int         m_read_fd;
+    QString     m_directory;
+    int         m_dumps{0};
+    QSocketNotifier m_notifier;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SPAN(name) TraceSpan TRACE_CONCAT(trace_span_, __LINE__)(name)
+#define TRACE_SPAN_SINCE(name, begin_us) Trace::record(name, begin_us, Trace::now_us())
+#define TRACE_INSTALL_DUMP_SIGNAL(directory, parent) Trace::install_dump_signal(directory, parent)
+
+#else
+
+#define TRACE_SPAN(name) do {} while(0)
+#define TRACE_SPAN_SINCE(name, begin_us) do {} while(0)
+#define TRACE_INSTALL_DUMP_SIGNAL(directory, parent) do {} while(0)
+
+#endif
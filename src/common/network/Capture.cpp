@@ -0,0 +1,134 @@
+#include <chrono>
+
+#include <QtEndian>
+
+#include "Capture.h"
+
+bool CaptureWriter::open(const QString& path)
+{
+    close();
+
+    m_file.setFileName(path);
+    if(!m_file.open(QIODevice::ReadWrite))
+        return false;
+
+    if(m_file.size() == 0)
+    {
+        uchar version[4];
+        qToBigEndian<quint32>(CaptureFormat::version, version);
+        m_file.write(CaptureFormat::magic, CaptureFormat::magic_size);
+        m_file.write(reinterpret_cast<const char*>(version), sizeof(version));
+    }
+    else
+    {
+        // Only ever append to something we recognize
+        auto header = m_file.read(CaptureFormat::header_size);
+        if(header.size() != CaptureFormat::header_size ||
+           !header.startsWith(QByteArray(CaptureFormat::magic, CaptureFormat::magic_size)) ||
+           qFromBigEndian<quint32>(header.constData() + CaptureFormat::magic_size) != CaptureFormat::version)
+        {
+            m_file.close();
+            return false;
+        }
+
+        // A record cut short by a crash would hide everything after it
+        // from a reader, so cut the file back to the last whole record
+        const auto size = m_file.size();
+        qint64 end = CaptureFormat::header_size;
+        for(;;)
+        {
+            m_file.seek(end);
+            auto record = m_file.read(CaptureFormat::record_header_size);
+            if(record.size() != CaptureFormat::record_header_size)
+                break;
+
+            auto length = qFromBigEndian<quint32>(record.constData());
+            if(length > CaptureFormat::max_record || end + CaptureFormat::record_header_size + length > size)
+                break;
+
+            end += CaptureFormat::record_header_size + length;
+        }
+
+        if(end < size && !m_file.resize(end))
+        {
+            m_file.close();
+            return false;
+        }
+
+        m_file.seek(end);
+    }
+
+    m_records = 0;
+    return true;
+}
+
+void CaptureWriter::close()
+{
+    if(m_file.isOpen())
+        m_file.close();
+}
+
+void CaptureWriter::append(const QByteArray& datagram, quint32 origin, qint64 timestamp)
+{
+    if(!m_file.isOpen())
+        return;
+
+    uchar header[CaptureFormat::record_header_size];
+    qToBigEndian<quint32>(static_cast<quint32>(datagram.size()), header);
+    qToBigEndian<quint64>(static_cast<quint64>(timestamp), header + 4);
+    qToBigEndian<quint32>(origin, header + 12);
+
+    m_file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    m_file.write(datagram);
+
+    ++m_records;
+}
+
+qint64 CaptureWriter::now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+quint32 CaptureWriter::origin_of(const QString& address, quint16 port)
+{
+    return static_cast<quint32>(qHash(address) ^ (static_cast<uint>(port) << 16 | port));
+}
+
+bool CaptureReader::open(const QString& path)
+{
+    m_file.setFileName(path);
+    if(!m_file.open(QIODevice::ReadOnly))
+        return false;
+
+    auto header = m_file.read(CaptureFormat::header_size);
+    if(header.size() != CaptureFormat::header_size ||
+       !header.startsWith(QByteArray(CaptureFormat::magic, CaptureFormat::magic_size)) ||
+       qFromBigEndian<quint32>(header.constData() + CaptureFormat::magic_size) != CaptureFormat::version)
+    {
+        m_file.close();
+        return false;
+    }
+
+    return true;
+}
+
+bool CaptureReader::next(Record& record)
+{
+    if(!m_file.isOpen())
+        return false;
+
+    auto header = m_file.read(CaptureFormat::record_header_size);
+    if(header.size() != CaptureFormat::record_header_size)
+        return false;
+
+    auto length = qFromBigEndian<quint32>(header.constData());
+    if(length > CaptureFormat::max_record)
+        return false;
+
+    record.timestamp = static_cast<qint64>(qFromBigEndian<quint64>(header.constData() + 4));
+    record.origin = qFromBigEndian<quint32>(header.constData() + 12);
+    record.datagram = m_file.read(length);
+
+    return record.datagram.size() == static_cast<int>(length);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+#include <QByteArray>
+#include <QSharedPointer>
+
+//---------------------------------------------------------------------------
+// Capture
+//
+// An append-only recording of the datagrams a Receiver heard, exactly as
+// they arrived (framed datagrams are kept framed, so a replay exercises
+// the decode path, too).
+//
+//   file header:   "DASHDCAP" version (u32)
+//   each record:   length (u32) timestamp (u64, microseconds since the
+//                  epoch) origin (u32, a hash of the sender's address and
+//                  port) datagram[length]
+//
+// All integers are big endian.  A record cut short by a crash is ignored
+// when reading, and cut off when the capture is next opened for appending.
+//---------------------------------------------------------------------------
+
+class CaptureWriter
+{
+public:
+    CaptureWriter() = default;
+    ~CaptureWriter() { close(); }
+
+    // Appends to 'path' if it already holds a capture, after any torn
+    // last record is truncated
+    bool        open(const QString& path);
+    void        close();
+    bool        is_open() const { return m_file.isOpen(); }
+
+    void        append(const QByteArray& datagram, quint32 origin, qint64 timestamp = now());
+
+    quint64     records() const { return m_records; }
+
+    static qint64 now();
+    static quint32 origin_of(const QString& address, quint16 port);
+
+private:    // data members
+    QFile       m_file;
+    quint64     m_records{0};
+};
+
+using CaptureWriterPtr = QSharedPointer<CaptureWriter>;
+
+class CaptureReader
+{
+public:
+    struct Record
+    {
+        qint64      timestamp{0};
+        quint32     origin{0};
+        QByteArray  datagram;
+    };
+
+public:
+    CaptureReader() = default;
+
+    bool        open(const QString& path);
+    bool        next(Record& record);
+
+private:    // data members
+    QFile       m_file;
+};
+
+namespace CaptureFormat
+{
+    constexpr char magic[] = "DASHDCAP";
+    constexpr int magic_size{8};
+    constexpr quint32 version{1};
+    constexpr int header_size{magic_size + 4};
+    constexpr int record_header_size{4 + 8 + 4};
+    // Nothing on the ring comes close; anything larger means corruption
+    constexpr quint32 max_record{1024 * 1024};
+}
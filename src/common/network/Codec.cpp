@@ -0,0 +1,267 @@
+#include <cstring>
+
+#include <QDateTime>
+
+#ifdef QT_WIN
+#include <QtZlib/zlib.h>
+#else
+#include <zlib.h>
+#endif
+
+#include "Codec.h"
+
+// Deflate window used for both directions; large enough to hold the
+// dictionary plus a typical report
+constexpr int window_bits{12};
+
+const QByteArray& Codec::dictionary()
+{
+    // zlib favors matches near the end of the dictionary, so the strings
+    // every report carries come last.
+    static const QByteArray dict(
+        "%20is%20reporting%20%2F%20failing%20RAID%20members."
+        "%20reports%20%2F%20members%20operating%20normally."
+        "%25%20free%20space%20remaining."
+        "%2Fdev%2Fmd%2Fmedia%2Fdata%2Fhome%2Fvar%2Fmnt%2F"
+        "File%20system%20has%20less%20than%20free%20space"
+        "raid_monitor_md0raid1%20%27md0%27raid5%20%27md1%27raid10"
+        "Collector%20shutting%20down%3B%20flagging%20offline."
+        "Sensor%20update%20overdue%3B%20flagging%20offline."
+        "{ \"dashboard_id\" : \"\", \"action\" : \"initialize\" }"
+        "\"warning\"\"error\"\"offline\"\"deceased\"\"critical\"\"poor\""
+        "{ \"domain_id\" : \"\", \"domain_name\" : \"\",  \"type\" : \"sensor\",  \"updated\" : \"\",  "
+        "\"sensor_name\" : \"\", \"sensor_state\" : \"healthy\",  \"sensor_message\" : \"\" }"
+    );
+    return dict;
+}
+
+QByteArray Codec::compress(const QByteArray& data)
+{
+    QByteArray result;
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if(deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, -window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return result;
+
+    const auto& dict = dictionary();
+    deflateSetDictionary(&stream, reinterpret_cast<const Bytef*>(dict.constData()), static_cast<uInt>(dict.size()));
+
+    result.resize(static_cast<int>(deflateBound(&stream, static_cast<uLong>(data.size()))));
+
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(result.data());
+    stream.avail_out = static_cast<uInt>(result.size());
+
+    if(deflate(&stream, Z_FINISH) == Z_STREAM_END)
+        result.resize(static_cast<int>(stream.total_out));
+    else
+        result.clear();
+
+    deflateEnd(&stream);
+    return result;
+}
+
+QByteArray Codec::decompress(const QByteArray& data, bool* ok)
+{
+    QByteArray result;
+    if(ok)
+        *ok = false;
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if(inflateInit2(&stream, -window_bits) != Z_OK)
+        return result;
+
+    const auto& dict = dictionary();
+    inflateSetDictionary(&stream, reinterpret_cast<const Bytef*>(dict.constData()), static_cast<uInt>(dict.size()));
+
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+    stream.avail_in = static_cast<uInt>(data.size());
+
+    // Reports compress to somewhere around a third of their size, so this
+    // usually succeeds without growing the buffer.
+    result.resize(qMax(1024, data.size() * 4));
+
+    int status = Z_OK;
+    while(status == Z_OK)
+    {
+        stream.next_out = reinterpret_cast<Bytef*>(result.data()) + stream.total_out;
+        stream.avail_out = static_cast<uInt>(result.size() - static_cast<int>(stream.total_out));
+
+        status = inflate(&stream, Z_FINISH);
+        if(status == Z_BUF_ERROR && stream.avail_out == 0)
+        {
+            if(result.size() >= max_payload)
+                break;
+            result.resize(qMin(result.size() * 2, max_payload));
+            status = Z_OK;
+        }
+    }
+
+    if(status == Z_STREAM_END)
+    {
+        result.resize(static_cast<int>(stream.total_out));
+        if(ok)
+            *ok = true;
+    }
+    else
+        result.clear();
+
+    inflateEnd(&stream);
+    return result;
+}
+
+QList<QByteArray> Codec::encode(const QByteArray& payload, quint32 message_id, int mtu, bool compress)
+{
+    QList<QByteArray> frames;
+
+    int flags = 0;
+    auto body = payload;
+    if(compress)
+    {
+        auto compressed = Codec::compress(payload);
+        if(!compressed.isEmpty() && compressed.size() < payload.size())
+        {
+            body = compressed;
+            flags |= Compressed;
+        }
+    }
+
+    const int chunk = qMax(1, mtu - header_size);
+    const int count = qMax(1, (body.size() + chunk - 1) / chunk);
+    if(count > max_fragments)
+        return frames;
+
+    if(count > 1)
+        flags |= Fragment;
+
+    for(int index = 0;index < count;++index)
+    {
+        auto piece = body.mid(index * chunk, chunk);
+
+        QByteArray frame;
+        frame.reserve(header_size + piece.size());
+        frame.append(static_cast<char>(frame_magic));
+        frame.append(static_cast<char>(flags));
+        frame.append(static_cast<char>((message_id >> 24) & 0xFF));
+        frame.append(static_cast<char>((message_id >> 16) & 0xFF));
+        frame.append(static_cast<char>((message_id >> 8) & 0xFF));
+        frame.append(static_cast<char>(message_id & 0xFF));
+        frame.append(static_cast<char>(index));
+        frame.append(static_cast<char>(count));
+        frame.append(piece);
+
+        frames.append(frame);
+    }
+
+    return frames;
+}
+
+QByteArray Reassembler::finish(const QByteArray& payload, int flags)
+{
+    if(!(flags & Codec::Compressed))
+        return payload;
+
+    bool ok;
+    auto result = Codec::decompress(payload, &ok);
+    if(!ok)
+        ++m_invalid;
+    return result;
+}
+
+void Reassembler::expire(qint64 now)
+{
+    auto iter = m_partials.begin();
+    while(iter != m_partials.end())
+    {
+        if(now - iter.value().first_seen > partial_lifetime)
+        {
+            iter = m_partials.erase(iter);
+            ++m_expired;
+        }
+        else
+            ++iter;
+    }
+}
+
+QByteArray Reassembler::accept(const QByteArray& frame, const QString& origin)
+{
+    if(!Codec::is_framed(frame) || frame.size() < Codec::header_size)
+    {
+        ++m_invalid;
+        return QByteArray();
+    }
+
+    const auto* header = reinterpret_cast<const unsigned char*>(frame.constData());
+    const int flags = header[1];
+    const quint32 message_id = (static_cast<quint32>(header[2]) << 24) |
+                               (static_cast<quint32>(header[3]) << 16) |
+                               (static_cast<quint32>(header[4]) << 8) |
+                                static_cast<quint32>(header[5]);
+    const int index = header[6];
+    const int count = header[7];
+    const auto payload = frame.mid(Codec::header_size);
+
+    if(!(flags & Codec::Fragment))
+        return finish(payload, flags);
+
+    if(count == 0 || index >= count)
+    {
+        ++m_invalid;
+        return QByteArray();
+    }
+
+    const auto now = QDateTime::currentMSecsSinceEpoch();
+    const auto key = QString("%1/%2").arg(origin).arg(message_id);
+
+    if(!m_partials.contains(key))
+    {
+        expire(now);
+
+        // Still full: give up on the oldest message
+        if(m_partials.count() >= max_partials)
+        {
+            auto oldest = m_partials.begin();
+            for(auto iter = m_partials.begin();iter != m_partials.end();++iter)
+            {
+                if(iter.value().first_seen < oldest.value().first_seen)
+                    oldest = iter;
+            }
+            m_partials.erase(oldest);
+            ++m_expired;
+        }
+
+        Partial partial;
+        partial.first_seen = now;
+        partial.flags = flags;
+        for(int i = 0;i < count;++i)
+            partial.fragments.append(QByteArray());
+        m_partials[key] = partial;
+    }
+
+    auto& partial = m_partials[key];
+    if(partial.fragments.count() != count)
+    {
+        ++m_invalid;
+        return QByteArray();
+    }
+
+    if(partial.fragments[index].isNull())
+    {
+        // Keep the slot non-null even for an empty piece, so duplicates are recognized
+        partial.fragments[index] = payload.isEmpty() ? QByteArray("", 0) : payload;
+        ++partial.received;
+    }
+
+    if(partial.received < count)
+        return QByteArray();
+
+    QByteArray body;
+    foreach(const auto& fragment, partial.fragments)
+        body.append(fragment);
+
+    m_partials.remove(key);
+    return finish(body, flags);
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <QMap>
+#include <QList>
+#include <QString>
+#include <QByteArray>
+
+//---------------------------------------------------------------------------
+// Codec
+//
+// Optional framing for datagrams on the multicast ring.  A framed datagram
+// starts with a one-byte magic value that can never begin a JSON document,
+// so plain JSON datagrams pass through Receivers untouched.
+//
+//   [0]    magic (0xD5)
+//   [1]    flags (Compressed, Fragment)
+//   [2-5]  message id (big endian)
+//   [6]    fragment index
+//   [7]    fragment count
+//   [8..]  payload
+//
+// Compression is raw deflate primed with a preset dictionary of the
+// vocabulary our reports are made of, which is what lets even short reports
+// shrink.  Payloads that would exceed the MTU are split into fragments and
+// put back together by a Reassembler on the receiving side.
+//---------------------------------------------------------------------------
+
+class Codec
+{
+public:     // typedefs and enums
+    enum Flags {
+        Compressed = 0x01,
+        Fragment   = 0x02
+    };
+
+    static constexpr unsigned char frame_magic{0xD5};
+    static constexpr int header_size{8};
+    static constexpr int default_mtu{1400};
+    static constexpr int max_fragments{255};
+    // Refuse to inflate anything claiming to be larger than this
+    static constexpr int max_payload{1024 * 1024};
+
+public:
+    static bool         is_framed(const QByteArray& datagram) { return !datagram.isEmpty() && static_cast<unsigned char>(datagram[0]) == frame_magic; }
+
+    // Frame 'payload' for the wire.  Compression is only used when it
+    // actually saves space.  An empty list means the payload was too large.
+    static QList<QByteArray> encode(const QByteArray& payload, quint32 message_id, int mtu = default_mtu, bool compress = true);
+
+    static QByteArray   compress(const QByteArray& data);
+    static QByteArray   decompress(const QByteArray& data, bool* ok = nullptr);
+
+    static const QByteArray& dictionary();
+};
+
+//---------------------------------------------------------------------------
+// Reassembler
+//
+// Turns framed datagrams back into plain payloads.  Fragments are held per
+// origin and message id until the set is complete; partial messages are
+// bounded in number and age so a lossy ring cannot make us grow.
+//---------------------------------------------------------------------------
+
+class Reassembler
+{
+public:
+    Reassembler() = default;
+
+    // Returns the decoded payload, or an empty array if the frame was
+    // invalid or more fragments are still needed.
+    QByteArray  accept(const QByteArray& frame, const QString& origin);
+
+    quint64     expired() const { return m_expired; }
+    quint64     invalid() const { return m_invalid; }
+
+private:    // typedefs and enums
+    struct Partial
+    {
+        qint64      first_seen{0};
+        int         flags{0};
+        int         received{0};
+        QList<QByteArray> fragments;
+    };
+
+    using PartialMap = QMap<QString, Partial>;
+
+    static constexpr int max_partials{256};
+    static constexpr qint64 partial_lifetime{5000};    // milliseconds
+
+private:    // methods
+    QByteArray  finish(const QByteArray& payload, int flags);
+    void        expire(qint64 now);
+
+private:    // data members
+    PartialMap  m_partials;
+
+    quint64     m_expired{0};
+    quint64     m_invalid{0};
+};
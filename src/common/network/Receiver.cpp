@@ -1,17 +1,47 @@
+#ifdef QT_LINUX
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
 #include <QNetworkDatagram>
 
 #include "Receiver.h"
+#include "Trace.h"
 
 // https://code.qt.io/cgit/qt/qtbase.git/tree/examples/network/multicastreceiver?h=5.15
 
+#ifdef QT_LINUX
+// Linux hands a socket bound to a wildcard address the datagrams of every
+// group joined on its port by anyone on the host; limit it to the groups
+// it joined itself, so Receivers (a relay's included) sharing a port with
+// another group never hear that group's traffic
+static void join_only_own_groups(QUdpSocket& socket, int level, int option)
+{
+    auto fd = socket.socketDescriptor();
+    if(fd == -1)
+        return;
+
+    int all = 0;
+    setsockopt(static_cast<int>(fd), level, option, &all, sizeof(all));
+}
+#endif
+
 Receiver::Receiver(uint16_t group_port, const QString& ipv4_group, const QString& ipv6_group, QObject* parent) :
     QObject(parent), group_address_ipv4(ipv4_group), group_address_ipv6(ipv6_group), m_group_port(group_port)
 {
     udp_socket_ipv4.bind(QHostAddress::AnyIPv4, m_group_port, QUdpSocket::ShareAddress);
+#ifdef QT_LINUX
+    join_only_own_groups(udp_socket_ipv4, IPPROTO_IP, IP_MULTICAST_ALL);
+#endif
     udp_socket_ipv4.joinMulticastGroup(group_address_ipv4);
 
     if (udp_socket_ipv6.bind(QHostAddress::AnyIPv6, m_group_port, QUdpSocket::ShareAddress))
+    {
+#if defined(QT_LINUX) && defined(IPV6_MULTICAST_ALL)
+        join_only_own_groups(udp_socket_ipv6, IPPROTO_IPV6, IPV6_MULTICAST_ALL);
+#endif
         udp_socket_ipv6.joinMulticastGroup(group_address_ipv6);
+    }
 
     connect(&udp_socket_ipv4, &QUdpSocket::readyRead, this, &Receiver::slot_process_datagrams);
     connect(&udp_socket_ipv6, &QUdpSocket::readyRead, this, &Receiver::slot_process_datagrams);
@@ -23,23 +53,69 @@ Receiver::~Receiver()
     udp_socket_ipv6.leaveMulticastGroup(group_address_ipv6);
 }
 
+bool Receiver::set_capture(const QString& path)
+{
+    m_capture.clear();
+    if(path.isEmpty())
+        return true;
+
+    auto capture = CaptureWriterPtr(new CaptureWriter());
+    if(!capture->open(path))
+        return false;
+
+    m_capture = capture;
+    return true;
+}
+
+void Receiver::forward(const QByteArray& datagram, const QHostAddress& sender, quint16 sender_port)
+{
+    if(m_capture)
+        m_capture->append(datagram, CaptureWriter::origin_of(sender.toString(), sender_port));
+
+    if(!Codec::is_framed(datagram))
+    {
+        if(!m_subscription || m_subscription->accepts(datagram))
+            emit signal_datagram_available(datagram);
+        return;
+    }
+
+    auto payload = m_reassembler.accept(datagram, QString("%1:%2").arg(sender.toString()).arg(sender_port));
+    if(!payload.isEmpty() && (!m_subscription || m_subscription->accepts(payload)))
+        emit signal_datagram_available(payload);
+}
+
 void Receiver::slot_process_datagrams()
 {
+    TRACE_SPAN("Receiver::slot_process_datagrams");
+
+    if(m_priority)
+        m_priority->drain();
+
+    int count = 0;
+
     // using QUdpSocket::readDatagram (API since Qt 4)
     while (udp_socket_ipv4.hasPendingDatagrams())
     {
+        if(m_priority && ++count % priority_check_interval == 0)
+            m_priority->drain();
+
         QByteArray datagram;
+        QHostAddress sender;
+        quint16 sender_port{0};
         datagram.resize(static_cast<int>(udp_socket_ipv4.pendingDatagramSize()));
-        udp_socket_ipv4.readDatagram(datagram.data(), datagram.size());
+        udp_socket_ipv4.readDatagram(datagram.data(), datagram.size(), &sender, &sender_port);
 
-        emit signal_datagram_available(datagram);
+        forward(datagram, sender, sender_port);
     }
 
     // using QUdpSocket::receiveDatagram (API since Qt 5.8)
     while (udp_socket_ipv6.hasPendingDatagrams())
     {
+        if(m_priority && ++count % priority_check_interval == 0)
+            m_priority->drain();
+
         auto dgram{udp_socket_ipv6.receiveDatagram()};
 
-        emit signal_datagram_available(dgram.data());
+        forward(dgram.data(), dgram.senderAddress(), static_cast<quint16>(dgram.senderPort()));
     }
 }
@@ -4,8 +4,25 @@
 #include <QHostAddress>
 #include <QSharedPointer>
 
+#include "Codec.h"
+#include "Capture.h"
+#include "Subscription.h"
+
 // Receiver monitors traffic on the multicast group, and forwards any
-// to interested parties.
+// to interested parties.  Framed datagrams (see Codec) are decompressed
+// and reassembled here, so listeners only ever see plain payloads.
+//
+// A Receiver can also record everything it hears to a Capture file, for
+// replaying later, and drop what a Subscription does not want before
+// anyone decodes it.
+//
+// A Receiver can be given a priority Receiver (listening to a group that
+// carries only urgent reports), which it drains before its own sockets and
+// again regularly while draining them, so urgent reports never wait behind
+// a backlog of routine ones.
+//
+// On Linux, a Receiver hears only the groups it joined, even when another
+// socket on the host has joined a different group on the same port.
 
 class Receiver : public QObject
 {
@@ -15,12 +32,32 @@ public:
     explicit Receiver(uint16_t group_port, const QString& ipv4_group, const QString& ipv6_group, QObject *parent = nullptr);
     virtual ~Receiver();
 
+    // Record every datagram heard to 'path' (appending to an existing
+    // capture); an empty path stops recording.
+    bool        set_capture(const QString& path);
+
+    // Forward only what 'subscription' accepts (a null one accepts everything)
+    void        set_subscription(SubscriptionPtr subscription) { m_subscription = subscription; }
+    SubscriptionPtr subscription() const { return m_subscription; }
+
+    void        set_priority(QSharedPointer<Receiver> priority) { m_priority = priority; }
+
+    // Forward everything waiting on our sockets now
+    void        drain() { slot_process_datagrams(); }
+
 signals:
     void signal_datagram_available(const QByteArray& dg);
 
 private slots:
     void slot_process_datagrams();
 
+private:    // typedefs and enums
+    // Routine datagrams handled between checks of the priority Receiver
+    static constexpr int priority_check_interval{16};
+
+private:    // methods
+    void        forward(const QByteArray& datagram, const QHostAddress& sender, quint16 sender_port);
+
 private:
     QUdpSocket udp_socket_ipv4;
     QUdpSocket udp_socket_ipv6;
@@ -29,6 +66,14 @@ private:
     QHostAddress group_address_ipv6;
 
     uint16_t m_group_port{0};
+
+    Reassembler m_reassembler;
+
+    CaptureWriterPtr m_capture;
+
+    SubscriptionPtr m_subscription;
+
+    QSharedPointer<Receiver> m_priority;
 };
 
 using ReceiverPtr = QSharedPointer<Receiver>;
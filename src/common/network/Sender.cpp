@@ -1,13 +1,39 @@
+#ifdef QT_LINUX
+#include <cerrno>
+#include <cstring>
+#include <arpa/inet.h>
+#endif
+
+#include <QThread>
+#include <QRandomGenerator>
+#include <QDateTime>
+#include <QVarLengthArray>
+
 #include "Sender.h"
+#include "Trace.h"
+#include "SharedTypes.h"
 
 // https://code.qt.io/cgit/qt/qtbase.git/tree/examples/network/multicastsender?h=5.15
 
+// How long the pacer waits before trying again when the bucket is empty
+// or the socket buffer is full
+constexpr int pacer_interval{5};
+
 Sender::Sender(uint16_t group_port, const QString& ipv4_group, const QString& ipv6_group, QObject* parent) :
     QObject(parent),
-    m_group_address_ipv4(ipv4_group),
-    m_group_address_ipv6(ipv6_group),
     m_group_port(group_port)
 {
+    // Each address goes to the family it actually belongs to, whichever
+    // argument it arrived in; an unusable address is never sent to.
+    foreach(const auto& group, QStringList() << ipv4_group << ipv6_group)
+    {
+        QHostAddress address(group);
+        if(address.protocol() == QAbstractSocket::IPv4Protocol && m_group_address_ipv4.isNull())
+            m_group_address_ipv4 = address;
+        else if(address.protocol() == QAbstractSocket::IPv6Protocol && m_group_address_ipv6.isNull())
+            m_group_address_ipv6 = address;
+    }
+
     // Force binding to their respective families
     m_udp_socket_ipv4.bind(QHostAddress(QHostAddress::AnyIPv4), 0);
     m_udp_socket_ipv6.bind(QHostAddress(QHostAddress::AnyIPv6), m_udp_socket_ipv4.localPort());
@@ -16,16 +42,417 @@ Sender::Sender(uint16_t group_port, const QString& ipv4_group, const QString& ip
     // (one is the default, but I'm doing it explicitly to remind
     // you, dear reader, of the limitation)
     m_udp_socket_ipv4.setSocketOption(QAbstractSocket::MulticastTtlOption, 1);
+
+    if(!m_group_address_ipv4.isNull() && m_udp_socket_ipv4.state() == QAbstractSocket::BoundState)
+        m_families |= IPv4;
+
+    if(!m_group_address_ipv6.isNull() && m_udp_socket_ipv6.state() == QAbstractSocket::BoundState)
+        m_families |= IPv6;
+
+#ifdef QT_LINUX
+    memset(&m_sockaddr_ipv4, 0, sizeof(m_sockaddr_ipv4));
+    m_sockaddr_ipv4.sin_family = AF_INET;
+    m_sockaddr_ipv4.sin_port = htons(m_group_port);
+    m_sockaddr_ipv4.sin_addr.s_addr = htonl(m_group_address_ipv4.toIPv4Address());
+
+    memset(&m_sockaddr_ipv6, 0, sizeof(m_sockaddr_ipv6));
+    m_sockaddr_ipv6.sin6_family = AF_INET6;
+    m_sockaddr_ipv6.sin6_port = htons(m_group_port);
+    auto ipv6 = m_group_address_ipv6.toIPv6Address();
+    memcpy(&m_sockaddr_ipv6.sin6_addr, &ipv6, sizeof(m_sockaddr_ipv6.sin6_addr));
+
+    m_batch.reserve(max_batch);
+    m_messages.reserve(max_batch);
+    m_vectors.reserve(max_batch);
+#endif
+
+    // Message ids only need to be unique per Sender among the fragments in flight
+    m_message_id = QRandomGenerator::global()->generate();
+
+    m_last_refill = QDateTime::currentMSecsSinceEpoch();
+
+    m_pacer.setInterval(pacer_interval);
+    connect(&m_pacer, &QTimer::timeout, this, &Sender::slot_drain);
+}
+
+void Sender::set_ttl(int hops)
+{
+    // Relays may need their datagrams to cross routers
+    m_udp_socket_ipv4.setSocketOption(QAbstractSocket::MulticastTtlOption, qBound(1, hops, 255));
+    m_udp_socket_ipv6.setSocketOption(QAbstractSocket::MulticastTtlOption, qBound(1, hops, 255));
+}
+
+void Sender::set_dscp(int dscp)
+{
+    // DSCP is the top six bits of the (IPv4) TOS / (IPv6) traffic class byte
+    auto traffic_class = qBound(0, dscp, 63) << 2;
+    m_udp_socket_ipv4.setSocketOption(QAbstractSocket::TypeOfServiceOption, traffic_class);
+#ifdef QT_LINUX
+    // Qt only knows the IPv4 option
+    auto fd = static_cast<int>(m_udp_socket_ipv6.socketDescriptor());
+    if(fd >= 0)
+        ::setsockopt(fd, IPPROTO_IPV6, IPV6_TCLASS, &traffic_class, sizeof(traffic_class));
+#endif
+}
+
+void Sender::set_rate(int per_second, int burst)
+{
+    m_rate = qMax(1, per_second);
+    m_burst = qMax(1, burst);
+    m_tokens = qMin(m_tokens, m_burst);
+}
+
+void Sender::enqueue(const QByteArray& datagram, const QString& key)
+{
+    if(!key.isEmpty() && m_queued_keys.contains(key))
+    {
+        // Only the latest state matters; the waiting one (and all of its
+        // fragments) is stale
+        foreach(auto iter, m_queued_keys.values(key))
+            m_queue.erase(iter);
+        m_queued_keys.remove(key);
+        ++m_dropped;
+    }
+
+    QList<QByteArray> frames;
+    if(m_compress && !m_stamp_sent)
+    {
+        frames = Codec::encode(datagram, m_message_id++, m_mtu);
+        if(frames.isEmpty())
+        {
+            // Too large to send even in fragments
+            ++m_errors;
+            return;
+        }
+    }
+    else
+        frames.append(datagram);
+
+    if(frames.count() > m_queue_limit)
+    {
+        // Could never be queued whole
+        ++m_dropped;
+        return;
+    }
+
+    // Make room by dropping whole datagrams, so no fragment is left queued
+    // without the rest of its message
+    while(!m_queue.empty() && static_cast<int>(m_queue.size()) + frames.count() > m_queue_limit)
+        drop_front_message();
+
+    auto message = m_next_message++;
+    foreach(const auto& frame, frames)
+    {
+        Outbound outbound;
+        outbound.datagram = frame;
+        outbound.key = key;
+        outbound.message = message;
+        outbound.families = m_families;
+        outbound.ready = !m_stamp_sent;
+
+        m_queue.push_back(outbound);
+        if(!key.isEmpty())
+            m_queued_keys.insert(key, std::prev(m_queue.end()));
+        ++m_queued;
+    }
+}
+
+void Sender::send_datagram(const QByteArray& datagram, const QString& key)
+{
+    TRACE_SPAN("Sender::send_datagram");
+
+    if(!m_families)
+        return;
+
+    enqueue(datagram, key);
+
+    // Nothing ahead of us means there is no reason to wait for the pacer
+    if(!m_pacer.isActive())
+        slot_drain();
+}
+
+void Sender::send_datagrams(const QList<QByteArray>& datagrams, const QStringList& keys)
+{
+    if(!m_families)
+        return;
+
+    Q_ASSERT(keys.isEmpty() || keys.count() == datagrams.count());
+
+    for(int i = 0;i < datagrams.count();++i)
+        enqueue(datagrams[i], keys.isEmpty() ? QString() : keys[i]);
+
+    if(!m_pacer.isActive())
+        slot_drain();
+}
+
+void Sender::refill()
+{
+    auto now = QDateTime::currentMSecsSinceEpoch();
+    m_tokens = qMin(m_burst, m_tokens + ((now - m_last_refill) * m_rate) / 1000.0);
+    m_last_refill = now;
+}
+
+void Sender::prepare(int budget)
+{
+    auto now = QDateTime::currentMSecsSinceEpoch();
+
+    int count = 0;
+    auto iter = m_queue.begin();
+    while(iter != m_queue.end() && count < budget)
+    {
+        if(iter->ready)
+        {
+            ++iter;
+            ++count;
+            continue;
+        }
+
+        SharedTypes::stamp_sent(iter->datagram, now);
+        iter->ready = true;
+
+        if(m_compress)
+        {
+            auto frames = Codec::encode(iter->datagram, m_message_id++, m_mtu);
+            if(frames.isEmpty())
+            {
+                // Too large to send even in fragments
+                ++m_errors;
+                if(!iter->key.isEmpty())
+                    m_queued_keys.remove(iter->key, iter);
+                iter = m_queue.erase(iter);
+                continue;
+            }
+
+            // Make room for the extra fragments as enqueue() does, by
+            // dropping the oldest whole messages; when this one is the
+            // oldest left (or could never fit), it is the one dropped
+            if(frames.count() <= m_queue_limit)
+            {
+                while(static_cast<int>(m_queue.size()) - 1 + frames.count() > m_queue_limit &&
+                      m_queue.front().message != iter->message)
+                {
+                    auto before = m_queue.size();
+                    drop_front_message();
+                    count -= static_cast<int>(before - m_queue.size());
+                }
+            }
+
+            if(static_cast<int>(m_queue.size()) - 1 + frames.count() > m_queue_limit)
+            {
+                ++m_dropped;
+                if(!iter->key.isEmpty())
+                    m_queued_keys.remove(iter->key, iter);
+                iter = m_queue.erase(iter);
+                continue;
+            }
+
+            // The fragments take the datagram's place in the queue
+            iter->datagram = frames.takeFirst();
+            auto next = std::next(iter);
+            foreach(const auto& frame, frames)
+            {
+                Outbound outbound = *iter;
+                outbound.datagram = frame;
+
+                auto inserted = m_queue.insert(next, outbound);
+                if(!outbound.key.isEmpty())
+                    m_queued_keys.insert(outbound.key, inserted);
+            }
+        }
+
+        ++iter;
+        ++count;
+    }
+}
+
+void Sender::pop_front()
+{
+    if(!m_queue.front().key.isEmpty())
+        m_queued_keys.remove(m_queue.front().key, m_queue.begin());
+    m_queue.pop_front();
+}
+
+void Sender::drop_front_message()
+{
+    auto message = m_queue.front().message;
+    while(!m_queue.empty() && m_queue.front().message == message)
+        pop_front();
+    ++m_dropped;
 }
 
-void Sender::send_datagram(const QByteArray& datagram)
+#ifdef QT_LINUX
+Sender::WriteResult Sender::write_family(int family, int fd, struct sockaddr* address, socklen_t address_length)
 {
-    if (!m_group_address_ipv4.toString().isEmpty())
-        m_udp_socket_ipv4.writeDatagram(datagram, m_group_address_ipv4, m_group_port);
+    m_messages.clear();
+    m_vectors.clear();
 
-    if (!m_group_address_ipv6.toString().isEmpty())
+    // Collect the datagrams in this batch still owed to this family.  The
+    // vectors are sized before any pointers into them are taken.
+    QVarLengthArray<Outbound*, max_batch> pending;
+    for(auto outbound : m_batch)
     {
-        if (m_udp_socket_ipv6.state() == QAbstractSocket::BoundState)
-            m_udp_socket_ipv6.writeDatagram(datagram, m_group_address_ipv6, m_group_port);
+        if(outbound->families & family)
+            pending.append(outbound);
     }
+
+    if(pending.isEmpty())
+        return WriteResult::Sent;
+
+    m_messages.resize(static_cast<size_t>(pending.count()));
+    m_vectors.resize(static_cast<size_t>(pending.count()));
+
+    for(int i = 0;i < pending.count();++i)
+    {
+        auto& vector = m_vectors[static_cast<size_t>(i)];
+        // sendmmsg() does not write through the vector, so there is no need to detach
+        vector.iov_base = const_cast<char*>(pending[i]->datagram.constData());
+        vector.iov_len = static_cast<size_t>(pending[i]->datagram.size());
+
+        auto& message = m_messages[static_cast<size_t>(i)];
+        memset(&message, 0, sizeof(message));
+        message.msg_hdr.msg_name = address;
+        message.msg_hdr.msg_namelen = address_length;
+        message.msg_hdr.msg_iov = &vector;
+        message.msg_hdr.msg_iovlen = 1;
+    }
+
+    int offset = 0;
+    while(offset < pending.count())
+    {
+        auto count = ::sendmmsg(fd, m_messages.data() + offset, static_cast<unsigned int>(pending.count() - offset), 0);
+        if(count < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            if(errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)
+                return WriteResult::Retry;
+
+            // This datagram cannot be sent (e.g., too large); skip it
+            ++m_errors;
+            pending[offset]->families &= ~family;
+            ++offset;
+            continue;
+        }
+
+        for(int i = 0;i < count;++i)
+            pending[offset + i]->families &= ~family;
+        offset += count;
+    }
+
+    return WriteResult::Sent;
+}
+#else
+Sender::WriteResult Sender::write_pending(Outbound& outbound)
+{
+    // Each family is written at most once, so a retry after a full socket
+    // buffer only resends to the family that failed.
+
+    if(outbound.families & IPv4)
+    {
+        if(m_udp_socket_ipv4.writeDatagram(outbound.datagram, m_group_address_ipv4, m_group_port) < 0)
+        {
+            if(m_udp_socket_ipv4.error() == QAbstractSocket::TemporaryError)
+                return WriteResult::Retry;
+            ++m_errors;
+        }
+        outbound.families &= ~IPv4;
+    }
+
+    if(outbound.families & IPv6)
+    {
+        if(m_udp_socket_ipv6.writeDatagram(outbound.datagram, m_group_address_ipv6, m_group_port) < 0)
+        {
+            if(m_udp_socket_ipv6.error() == QAbstractSocket::TemporaryError)
+                return WriteResult::Retry;
+            ++m_errors;
+        }
+        outbound.families &= ~IPv6;
+    }
+
+    return WriteResult::Sent;
+}
+#endif
+
+Sender::WriteResult Sender::write_batch(int budget)
+{
+    auto result = WriteResult::Sent;
+    budget = qMin(budget, max_batch);
+
+    if(m_stamp_sent)
+        prepare(budget);
+
+#ifdef QT_LINUX
+    m_batch.clear();
+    for(auto iter = m_queue.begin();iter != m_queue.end() && static_cast<int>(m_batch.size()) < budget;++iter)
+        m_batch.push_back(&(*iter));
+
+    if(m_families & IPv4)
+        result = write_family(IPv4, static_cast<int>(m_udp_socket_ipv4.socketDescriptor()),
+                              reinterpret_cast<struct sockaddr*>(&m_sockaddr_ipv4), sizeof(m_sockaddr_ipv4));
+    if(result == WriteResult::Sent && (m_families & IPv6))
+        result = write_family(IPv6, static_cast<int>(m_udp_socket_ipv6.socketDescriptor()),
+                              reinterpret_cast<struct sockaddr*>(&m_sockaddr_ipv6), sizeof(m_sockaddr_ipv6));
+#else
+    int count = 0;
+    for(auto iter = m_queue.begin();iter != m_queue.end() && count < budget;++iter, ++count)
+    {
+        result = write_pending(*iter);
+        if(result == WriteResult::Retry)
+            break;
+    }
+#endif
+
+    // Retire whatever has gone out to every family
+    while(!m_queue.empty() && !m_queue.front().families)
+    {
+        pop_front();
+        m_tokens -= 1.0;
+        ++m_sent;
+    }
+
+    return result;
+}
+
+void Sender::slot_drain()
+{
+    refill();
+
+    while(!m_queue.empty() && m_tokens >= 1.0)
+    {
+        // EAGAIN: the socket buffer is full, give it a moment
+        if(write_batch(static_cast<int>(m_tokens)) == WriteResult::Retry)
+            break;
+    }
+
+    if(m_queue.empty())
+        m_pacer.stop();
+    else if(!m_pacer.isActive())
+        m_pacer.start();
+}
+
+void Sender::flush()
+{
+    m_pacer.stop();
+
+    // Bound the time we are willing to spend waiting on a full socket buffer
+    int retries = 100;
+
+    while(!m_queue.empty())
+    {
+        if(write_batch(max_batch) == WriteResult::Retry)
+        {
+            if(--retries == 0)
+            {
+                m_dropped += m_queue.size();
+                m_queue.clear();
+                m_queued_keys.clear();
+                break;
+            }
+
+            QThread::msleep(1);
+        }
+    }
+
+    // The pacer's budget does not apply here
+    m_tokens = qMax(m_tokens, 0.0);
 }
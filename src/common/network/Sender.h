@@ -1,9 +1,45 @@
 #pragma once
 
+#include <list>
+#include <vector>
+
+#ifdef QT_LINUX
+#include <sys/socket.h>
+#include <netinet/in.h>
+#endif
+
+#include <QMultiHash>
+#include <QTimer>
 #include <QUdpSocket>
 #include <QHostAddress>
 #include <QSharedPointer>
 
+#include "Codec.h"
+
+// Sender publishes datagrams to the multicast group.
+//
+// Datagrams are not written to the sockets directly; they pass through a
+// bounded outbound queue drained by a token-bucket pacer, so a burst (e.g.,
+// a full rebroadcast of cached reports) cannot overrun the socket buffer.
+// Datagrams may carry a key (typically the Sensor they describe): only the
+// latest state matters, so a newer datagram replaces an older one with the
+// same key that is still waiting.  When the queue is full, the oldest
+// datagram is dropped (all of its fragments, if it was fragmented).
+//
+// On Linux, the pacer hands everything its bucket allows to sendmmsg() in
+// one call per address family, rather than one syscall per datagram.
+//
+// A Collector may run a second Sender, marked with a higher DSCP, for the
+// reports that must not wait behind routine traffic.
+//
+// With compression enabled, each datagram is framed by Codec (compressed,
+// and fragmented if it exceeds the MTU).  Receivers decode framed
+// datagrams transparently, but Dashboards predating framing cannot.
+//
+// A Sender can also stamp Sensor reports with the time they actually leave
+// the queue ("sent"), so time spent waiting on the pacer counts against the
+// sender and not the network.  Such datagrams are framed as they leave, too.
+
 class Sender : public QObject
 {
     Q_OBJECT
@@ -11,9 +47,77 @@ class Sender : public QObject
 public:
     explicit Sender(uint16_t group_port, const QString& ipv4_group, const QString& ipv6_group, QObject* parent = nullptr);
 
-    void send_datagram(const QByteArray& datagram);
+    void        send_datagram(const QByteArray& datagram, const QString& key = QString());
+    // Queue a set of datagrams and transmit them together.  'keys', if
+    // provided, must parallel 'datagrams'.
+    void        send_datagrams(const QList<QByteArray>& datagrams, const QStringList& keys = QStringList());
+
+    // Send everything still queued, ignoring the pacer.  This blocks, and is
+    // intended for shutdown when the event loop is no longer running.
+    void        flush();
+
+    void        set_queue_limit(int limit) { m_queue_limit = qMax(1, limit); }
+    void        set_compression(bool enabled, int mtu = Codec::default_mtu) { m_compress = enabled; m_mtu = mtu; }
+    // Restamp the "sent" time of Sensor reports as they are dequeued
+    void        set_stamp_sent(bool enabled) { m_stamp_sent = enabled; }
+    void        set_rate(int per_second, int burst);
+    // Router hops multicast datagrams may cross (1 keeps them in this subnet)
+    void        set_ttl(int hops);
+    // Differentiated Services code point to mark datagrams with (e.g., 46
+    // for Expedited Forwarding), so routers and switches that honour it
+    // queue them ahead of best-effort traffic
+    void        set_dscp(int dscp);
+
+    int         pending() const { return static_cast<int>(m_queue.size()); }
+
+    quint64     queued() const { return m_queued; }
+    quint64     sent() const { return m_sent; }
+    quint64     dropped() const { return m_dropped; }
+    quint64     errors() const { return m_errors; }
+
+private slots:
+    void        slot_drain();
+
+private:    // typedefs and enums
+    enum Family {
+        IPv4 = 0x01,
+        IPv6 = 0x02
+    };
+
+    struct Outbound
+    {
+        QByteArray  datagram;
+        QString     key;
+        quint32     message{0};    // shared by the fragments of one datagram
+        int         families{0};   // families this datagram has yet to be written to
+        bool        ready{true};   // false until stamped (and framed) on the way out
+    };
+
+    using OutboundQueue = std::list<Outbound>;
+    // A fragmented datagram puts several entries in the queue under one key
+    using KeyMap = QMultiHash<QString, OutboundQueue::iterator>;
 
-private:
+    enum class WriteResult { Sent, Retry };
+
+    // Most datagrams handed to the kernel in a single call
+    static constexpr int max_batch{64};
+
+private:    // methods
+    void        enqueue(const QByteArray& datagram, const QString& key);
+    void        refill();
+    // Stamp and frame the first 'budget' datagrams, if not done yet
+    void        prepare(int budget);
+    WriteResult write_batch(int budget);
+#ifdef QT_LINUX
+    WriteResult write_family(int family, int fd, struct sockaddr* address, socklen_t address_length);
+#else
+    WriteResult write_pending(Outbound& outbound);
+#endif
+    void        pop_front();
+    // Drop the oldest datagram, with every fragment of it still queued
+    void        drop_front_message();
+
+private:    // data members
     QUdpSocket m_udp_socket_ipv4;
     QUdpSocket m_udp_socket_ipv6;
 
@@ -21,6 +125,42 @@ private:
     QHostAddress m_group_address_ipv6;
 
     uint16_t m_group_port{0};
+
+    // Which families we send to is settled once, at construction
+    int         m_families{0};
+
+#ifdef QT_LINUX
+    struct sockaddr_in  m_sockaddr_ipv4;
+    struct sockaddr_in6 m_sockaddr_ipv6;
+
+    // Scratch space for sendmmsg(), reused between batches
+    std::vector<Outbound*>      m_batch;
+    std::vector<struct mmsghdr> m_messages;
+    std::vector<struct iovec>   m_vectors;
+#endif
+
+    OutboundQueue m_queue;
+    KeyMap      m_queued_keys;
+    int         m_queue_limit{4096};
+    quint32     m_next_message{0};
+
+    bool        m_compress{false};
+    bool        m_stamp_sent{false};
+    int         m_mtu{Codec::default_mtu};
+    quint32     m_message_id{0};
+
+    // Token bucket
+    double      m_rate{2000.0};     // datagrams per second
+    double      m_burst{256.0};
+    double      m_tokens{256.0};
+    qint64      m_last_refill{0};
+
+    QTimer      m_pacer;
+
+    quint64     m_queued{0};
+    quint64     m_sent{0};
+    quint64     m_dropped{0};
+    quint64     m_errors{0};
 };
 
 using SenderPtr = QSharedPointer<Sender>;
@@ -0,0 +1,137 @@
+#include <QUrl>
+
+#include "Subscription.h"
+
+bool Subscription::accepts(const QByteArray& datagram)
+{
+    if(decide(datagram))
+    {
+        ++m_accepted;
+        return true;
+    }
+
+    ++m_dropped;
+    return false;
+}
+
+bool Subscription::decide(const QByteArray& datagram)
+{
+    auto domain_name = field(datagram, "domain_name");
+    // Not a Collector report (or not one we can read); let the model judge
+    if(domain_name.isEmpty())
+        return true;
+
+    if(!m_domains.isEmpty())
+    {
+        auto name = QUrl::fromPercentEncoding(domain_name);
+        bool found = false;
+        foreach(const QString& glob, m_domains)
+        {
+            if(matches_glob(name, glob))
+            {
+                found = true;
+                break;
+            }
+        }
+        if(!found)
+            return false;
+    }
+
+    auto sensor_name = field(datagram, "sensor_name");
+    // Whole-Domain notices carry no Sensor
+    if(sensor_name.isEmpty())
+        return true;
+
+    if(!m_sensors.isEmpty())
+    {
+        auto name = QUrl::fromPercentEncoding(sensor_name);
+        bool found = false;
+        foreach(const QString& prefix, m_sensors)
+        {
+            if(name.startsWith(prefix, Qt::CaseInsensitive))
+            {
+                found = true;
+                break;
+            }
+        }
+        if(!found)
+            return false;
+    }
+
+    if(m_minimum <= SharedTypes::SensorState::Healthy || field(datagram, "type") != "sensor")
+        return true;
+
+    auto key = field(datagram, "domain_id") + '/' + sensor_name;
+    auto state = SharedTypes::MsgText2State.value(QString::fromLatin1(field(datagram, "sensor_state")).toLower(),
+                                                  SharedTypes::SensorState::Undefined);
+    if(state >= m_minimum)
+    {
+        m_admitted.insert(key);
+        return true;
+    }
+
+    // The last word on a Sensor that is no longer of interest
+    return m_admitted.remove(key);
+}
+
+QStringList Subscription::cleaned(const QStringList& entries)
+{
+    QStringList result;
+    foreach(const QString& entry, entries)
+    {
+        if(!entry.trimmed().isEmpty())
+            result.append(entry.trimmed());
+    }
+    return result;
+}
+
+QByteArray Subscription::field(const QByteArray& datagram, const QByteArray& key)
+{
+    auto quoted = '"' + key + '"';
+    auto pos = datagram.indexOf(quoted);
+    if(pos < 0)
+        return QByteArray();
+
+    pos += quoted.size();
+    while(pos < datagram.size() && (datagram[pos] == ' ' || datagram[pos] == ':'))
+        ++pos;
+    if(pos >= datagram.size() || datagram[pos] != '"')
+        return QByteArray();
+
+    auto end = datagram.indexOf('"', pos + 1);
+    if(end < 0)
+        return QByteArray();
+
+    return datagram.mid(pos + 1, end - pos - 1);
+}
+
+bool Subscription::matches_glob(const QString& text, const QString& glob)
+{
+    // Iterative '*' matching with a single backtrack point
+    int t = 0, g = 0;
+    int star = -1, mark = 0;
+    while(t < text.size())
+    {
+        if(g < glob.size() && (glob[g] == '?' || glob[g].toLower() == text[t].toLower()))
+        {
+            ++t;
+            ++g;
+        }
+        else if(g < glob.size() && glob[g] == '*')
+        {
+            star = g++;
+            mark = t;
+        }
+        else if(star >= 0)
+        {
+            g = star + 1;
+            t = ++mark;
+        }
+        else
+            return false;
+    }
+
+    while(g < glob.size() && glob[g] == '*')
+        ++g;
+    return g == glob.size();
+}
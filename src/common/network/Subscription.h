@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QSet>
+#include <QString>
+#include <QByteArray>
+#include <QStringList>
+#include <QSharedPointer>
+
+#include "SharedTypes.h"
+
+//---------------------------------------------------------------------------
+// Subscription
+//
+// Which of the ring's traffic a Dashboard wants: Domains whose names match
+// one of a set of globs ('*' and '?'), Sensors whose names start with one
+// of a set of prefixes, and Sensor reports at or above a minimum state.
+// An empty set admits everything.
+//
+// A Receiver consults it for every datagram before anything is decoded.
+// The decision is made from a handful of fields picked out of the raw JSON
+// (Collectors write them unescaped, in a fixed order, near the start), so
+// unwanted traffic never costs a full parse.
+//
+// Reports below the minimum state are still admitted for a Sensor that was
+// admitted before, once, so a Dashboard sees it recover instead of holding
+// on to its last bad state.
+//---------------------------------------------------------------------------
+
+class Subscription
+{
+public:
+    Subscription() = default;
+
+    // Blank entries are ignored
+    void        set_domains(const QStringList& globs) { m_domains = cleaned(globs); }
+    void        set_sensors(const QStringList& prefixes) { m_sensors = cleaned(prefixes); }
+    void        set_minimum_state(SharedTypes::SensorState state) { m_minimum = state; }
+
+    bool        is_empty() const { return m_domains.isEmpty() && m_sensors.isEmpty() && m_minimum <= SharedTypes::SensorState::Healthy; }
+
+    bool        accepts(const QByteArray& datagram);
+
+    quint64     accepted() const { return m_accepted; }
+    quint64     dropped() const { return m_dropped; }
+
+    // The raw text of the string value of "key" in a Collector report, or
+    // an empty array if it is not there
+    static QByteArray field(const QByteArray& datagram, const QByteArray& key);
+    static bool matches_glob(const QString& text, const QString& glob);
+
+private:    // methods
+    bool        decide(const QByteArray& datagram);
+    static QStringList cleaned(const QStringList& entries);
+
+private:    // data members
+    QStringList m_domains;
+    QStringList m_sensors;
+    SharedTypes::SensorState m_minimum{SharedTypes::SensorState::Undefined};
+
+    // Sensors currently at or above the minimum state ("domain_id/sensor")
+    QSet<QByteArray> m_admitted;
+
+    quint64     m_accepted{0};
+    quint64     m_dropped{0};
+};
+
+using SubscriptionPtr = QSharedPointer<Subscription>;
@@ -0,0 +1,21 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    model \
+    collector \
+    dashboard \
+    codec_bench \
+    journal \
+    loadgen \
+    model_bench \
+    replay
+
+codec_bench.subdir = tools/codec-bench
+journal.subdir = tools/journal
+loadgen.subdir = tools/loadgen
+model_bench.subdir = tools/model-bench
+replay.subdir = tools/replay
+
+dashboard.depends = model
+model_bench.depends = model
+replay.depends = model
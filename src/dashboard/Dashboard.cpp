@@ -2,9 +2,12 @@
 
 #include <QUrl>
 #include <QTimer>
+#include <QDateTime>
 
 #include <QLabel>
 #include <QBitmap>
+#include <QToolTip>
+#include <QHelpEvent>
 #include <QPainterPath>
 
 #include <QHBoxLayout>
@@ -15,6 +18,7 @@
 
 #include "Domain.h"
 #include "Dashboard.h"
+#include "Trace.h"
 
 Dashboard::Dashboard(bool dark_mode, bool always_on_top, Orientation orientation, Direction direction, QFrame *parent)
     : QFrame{parent},
@@ -43,42 +47,48 @@ Dashboard::Dashboard(bool dark_mode, bool always_on_top, Orientation orientation
     layout->addSpacerItem(spacer);
     setLayout(layout);
 
-    m_housekeeping = TimerPtr(new QTimer());
-    m_housekeeping->setInterval(100);
-    connect(m_housekeeping.data(), &QTimer::timeout, this, &Dashboard::slot_housekeeping);
+    // Sensor labels show this instead of a plain tooltip, so the
+    // Sensor's recent history can be drawn beneath the text
+    m_history_tip = new QFrame(this, Qt::ToolTip);
+    m_history_tip->setFrameShape(QFrame::Box);
+    m_history_tip->setPalette(QToolTip::palette());
+    m_history_tip->setAutoFillBackground(true);
+    auto tip_layout = new QVBoxLayout(m_history_tip);
+    tip_layout->setMargin(4);
+    m_history_text = new QLabel();
+    m_history_text->setTextFormat(Qt::RichText);
+    tip_layout->addWidget(m_history_text);
+    m_history_timeline = new QLabel();
+    tip_layout->addWidget(m_history_timeline);
 }
 
-void Dashboard::slot_housekeeping()
+bool Dashboard::eventFilter(QObject* watched, QEvent* event)
 {
-    if(!m_animation_in_progress)
+    if(event->type() == QEvent::Paint && m_pending_paints.contains(watched))
     {
-        auto action_item = m_action_queue.dequeue();
-
-        auto domain = std::get<0>(action_item);
-        auto sensor = std::get<1>(action_item);
-        auto action = std::get<2>(action_item);
+        auto sensor = m_pending_paints.take(watched);
+        emit signal_sensor_painted(sensor, QDateTime::currentMSecsSinceEpoch());
+    }
 
-        switch(action)
-        {
-            case SensorAction::Add:
-                QTimer::singleShot(0, this, [this, sensor, domain]()->void{slot_add_sensor(sensor, domain);});
-                break;
-            case SensorAction::Delete:
-                QTimer::singleShot(0, this, [this, sensor]()->void{slot_del_sensor(sensor);});
-                break;
-            case SensorAction::Update:  // Update does not animate window sizing, so does not have to be queued
-            case SensorAction::None:
-            default:
-                break;
-        }
+    if(event->type() == QEvent::ToolTip && m_histories.contains(watched))
+    {
+        show_history_tip(qobject_cast<QLabel*>(watched), static_cast<QHelpEvent*>(event)->globalPos());
+        return true;
+    }
 
-        if(m_action_queue.isEmpty())
-            m_housekeeping->stop();
+    if((event->type() == QEvent::Leave || event->type() == QEvent::MouseButtonPress) && watched == m_history_label)
+    {
+        m_history_tip->hide();
+        m_history_label = nullptr;
     }
+
+    return QFrame::eventFilter(watched, event);
 }
 
 void Dashboard::paintEvent(QPaintEvent* /*event*/)
 {
+    TRACE_SPAN("Dashboard::paintEvent");
+
     // Keep the endcaps "pill" shaped regardless of the width/height
     qreal radius = (m_orientation == Orientation::Vertical) ? m_base_dim.width() * 0.75 : m_base_dim.height() * 0.75;
 
@@ -204,41 +214,148 @@ QString Dashboard::gen_tooltip(Sensor* sensor, const QString& base, const QStrin
     return(tooltip);
 }
 
+void Dashboard::show_history_tip(QLabel* label, const QPoint& pos)
+{
+    auto& cache = m_histories[label];
+
+    auto samples = cache.sensor->history();
+    QString caption;
+    if(samples.count() > 1)
+        caption = tr("Last %1 state changes since %2")
+                    .arg(samples.count() - 1)
+                    .arg(QDateTime::fromMSecsSinceEpoch(samples.first().when).toString());
+    else
+        caption = tr("No state changes");
+
+    m_history_text->setText(QString("%1<br>%2").arg(label->toolTip(), caption));
+    m_history_timeline->setPixmap(history_image(cache));
+
+    m_history_tip->adjustSize();
+    m_history_tip->move(pos + QPoint(2, 16));
+    m_history_tip->show();
+    m_history_label = label;
+}
+
+const QPixmap& Dashboard::history_image(HistoryCache& cache)
+{
+    auto revision = cache.sensor->history_revision();
+    if(!cache.image.isNull() && cache.revision == revision)
+        return cache.image;
+
+    static const QMap<SharedTypes::SensorState, QColor> colors {
+        { SharedTypes::SensorState::Healthy, QColor(0x4C, 0xAF, 0x50) },
+        { SharedTypes::SensorState::Poor, QColor(0xFF, 0xC1, 0x07) },
+        { SharedTypes::SensorState::Critical, QColor(0xF4, 0x43, 0x36) },
+        { SharedTypes::SensorState::Deceased, QColor(0x6A, 0x1B, 0x9A) },
+        { SharedTypes::SensorState::Offline, QColor(0x9E, 0x9E, 0x9E) },
+    };
+
+    QPixmap image(history_width, history_height);
+    image.fill(Qt::transparent);
+
+    auto samples = cache.sensor->history();
+    if(!samples.isEmpty())
+    {
+        QPainter painter(&image);
+
+        // Earlier states are as wide as they lasted; the current state,
+        // whose end we don't know yet, gets a fixed share on the right
+        const int tail = (samples.count() > 1) ? history_width / 8 : history_width;
+        const int scaled = history_width - tail;
+        const qint64 first = samples.first().when;
+        const qint64 span = qMax<qint64>(1, samples.last().when - first);
+
+        for(int i = 0;i < samples.count();++i)
+        {
+            int x0 = scaled;
+            int x1 = history_width;
+            if(i + 1 < samples.count())
+            {
+                x0 = static_cast<int>(scaled * (samples[i].when - first) / span);
+                // Even the briefest state stays visible
+                x1 = qMax(x0 + 1, static_cast<int>(scaled * (samples[i + 1].when - first) / span));
+            }
+
+            painter.fillRect(x0, 0, x1 - x0, history_height, colors.value(samples[i].state, Qt::black));
+        }
+    }
+
+    cache.image = image;
+    cache.revision = revision;
+    return cache.image;
+}
+
 void Dashboard::slot_add_sensor(SensorPtr sensor, Domain* domain)
 {
     if(!domain)
         domain = qobject_cast<Domain*>(sender());
 
-    if(!m_animation_in_progress)
-        animate_sensor_add(sensor, domain);
-    else
-    {
-        ActionData data{domain, sensor, SensorAction::Add};
-        m_action_queue.enqueue(data);
+    // Only the name is kept; the Domain may be gone before the batch lands
+    PendingAdd add{domain ? domain->name() : QString(), sensor};
+    m_pending_adds.append(add);
 
-        if(!m_housekeeping->isActive())
-            m_housekeeping->start();
-    }
+    schedule_layout();
 }
 
-void Dashboard::slot_del_sensor(SensorPtr sensor)//const QString& name)
+void Dashboard::slot_del_sensor(SensorPtr sensor)
 {
-    if(!m_animation_in_progress)
-        animate_del_sensor(sensor);
-    else
+    // A Sensor removed before it was ever shown needs no layout work,
+    // whether it is still waiting or already in the animating batch
+    for(int i = 0;i < m_pending_adds.count();++i)
     {
-        ActionData data{nullptr, sensor, SensorAction::Delete};
-        m_action_queue.enqueue(data);
+        if(m_pending_adds[i].sensor == sensor)
+        {
+            m_pending_adds.removeAt(i);
+            return;
+        }
+    }
 
-        if(!m_housekeeping->isActive())
-            m_housekeeping->start();
+    for(int i = 0;i < m_batch_adds.count();++i)
+    {
+        if(m_batch_adds[i].sensor == sensor)
+        {
+            m_batch_adds.removeAt(i);
+            return;
+        }
     }
+
+    m_pending_deletes[sensor->name()] = sensor;
+
+    schedule_layout();
+}
+
+void Dashboard::slot_del_sensors(const SensorList& sensors)
+{
+    // These all land in the same layout batch
+    foreach(const SensorPtr& sensor, sensors)
+        slot_del_sensor(sensor);
+}
+
+void Dashboard::schedule_layout()
+{
+    // Everything that arrives before the event loop comes around again
+    // (or before a running animation finishes) goes into one batch
+    if(m_layout_scheduled || m_layout_animation)
+        return;
+
+    m_layout_scheduled = true;
+    QTimer::singleShot(0, this, &Dashboard::slot_apply_layout);
 }
 
 void Dashboard::slot_update_sensor(SensorPtr sensor, const QString& message, bool notify)
 {
+    TRACE_SPAN("Dashboard::slot_update_sensor");
+
+    // The Sensor may still be waiting for the next layout batch; its
+    // label will be created with the latest state
+    if(!m_labels.contains(sensor->name()))
+        return;
+
     m_target_sensor = m_labels[sensor->name()];
 
+    // Note when this update actually reaches the screen
+    m_pending_paints[m_target_sensor] = sensor;
+
     QString image = Sensor::StateImages[sensor->state()];
     m_next_image = (m_orientation == Orientation::Vertical) ? QPixmap(image).scaledToWidth(m_base_dim.width()) : QPixmap(image).scaledToHeight(m_base_dim.height());
 
@@ -254,117 +371,164 @@ void Dashboard::slot_update_sensor(SensorPtr sensor, const QString& message, boo
 
     auto tooltip = gen_tooltip(sensor.data(), m_target_sensor->property("base_tooltip").toString(), message);
     m_target_sensor->setToolTip(tooltip);
+
+    // Keep an open history tip current
+    if(m_history_label == m_target_sensor)
+        show_history_tip(m_target_sensor, m_history_tip->pos() - QPoint(2, 16));
 }
 
-void Dashboard::animate_sensor_add(SensorPtr sensor, Domain* domain)
+void Dashboard::initialize_geometry()
 {
-    if(!domain)
-        domain = qobject_cast<Domain*>(sender());
+    // Perform first-sensor calculations.
+    auto g = geometry();
 
-    if(m_base_pos.isNull())
-    {
-        // Perform first-sensor calculations.
-        auto g = geometry();
+    m_base_pos = QPoint(g.left(), g.top());
+    m_base_dim = QSize(g.width(), g.height());
 
-        m_base_pos = QPoint(g.left(), g.top());
-        m_base_dim = QSize(g.width(), g.height());
+    m_current_pos = m_base_pos;
+    m_current_dim = m_base_dim;
 
-        m_current_pos = m_base_pos;
-        m_current_dim = m_base_dim;
+    QString image = QStringLiteral(":/images/Empty.png");
+    m_empty_image = (m_orientation == Orientation::Vertical) ? QPixmap(image).scaledToWidth(m_base_dim.width()) : QPixmap(image).scaledToHeight(m_base_dim.height());
+    m_sensor_size = (m_orientation == Orientation::Vertical) ? m_empty_image.height() : m_empty_image.width();
+}
+
+QRect Dashboard::layout_geometry(int count) const
+{
+    // The window grows along its orientation; growing up or left moves
+    // its origin, so the far edge stays put
+    const int extent = (m_sensor_size + m_margin) * count;
+    QRect g(m_current_pos, m_current_dim);
 
-        QString image = QStringLiteral(":/images/Empty.png");
-        m_empty_image = (m_orientation == Orientation::Vertical) ? QPixmap(image).scaledToWidth(m_base_dim.width()) : QPixmap(image).scaledToHeight(m_base_dim.height());
-        m_sensor_size = (m_orientation == Orientation::Vertical) ? m_empty_image.height() : m_empty_image.width();
+    if(m_orientation == Orientation::Vertical)
+    {
+        if(m_direction == Direction::Up)
+            g.moveTop(g.top() + g.height() - extent);
+        g.setHeight(extent);
+    }
+    else
+    {
+        if(m_direction == Direction::Left)
+            g.moveLeft(g.left() + g.width() - extent);
+        g.setWidth(extent);
     }
 
-    const int w = (m_orientation == Orientation::Vertical) ? m_current_dim.width() : (m_sensor_size + m_margin) * (m_labels.count() + 1);
-    const int h = (m_orientation == Orientation::Vertical) ? (m_sensor_size + m_margin) * (m_labels.count() + 1) : m_current_dim.height();
+    return g;
+}
 
-    const int w_delta = abs(w - m_current_dim.width());
-    const int h_delta = abs(h - m_current_dim.height());
+void Dashboard::slot_apply_layout()
+{
+    m_layout_scheduled = false;
 
-    // Resize the window to accomdate the new Sensor display (if required)
-    if(m_labels.count())
-    {
-        // Animate the movement/resizing of the window
+    // Whatever is pending now is picked up when the animation finishes
+    if(m_layout_animation)
+        return;
 
-        QPropertyAnimation* animation{nullptr};
-        if(m_orientation == Orientation::Vertical)
-        {
-            if(m_direction == Direction::Up)
-            {
-                // We are moving the window's origin and resizing at the same time
+    TRACE_SPAN("Dashboard::slot_apply_layout");
 
-                animation = new QPropertyAnimation(this, "geometry");
-                animation->setStartValue(QRect(m_current_pos.x(), m_current_pos.y(), m_current_dim.width(), m_current_dim.height()));
-                animation->setEndValue(QRect(m_current_pos.x(), m_current_pos.y() - h_delta, m_current_dim.width(), h));
+    // Sensors are removed from view first, and THEN the window collapses
+    for(auto iter = m_pending_deletes.cbegin();iter != m_pending_deletes.cend();++iter)
+        remove_sensor(iter.key());
+    m_pending_deletes.clear();
 
-                m_current_pos.setY(m_current_pos.y() - h_delta);
-            }
-            else if(m_direction == Direction::Down)
-            {
-                // We are only resizing the window
+    m_batch_adds.swap(m_pending_adds);
 
-                animation = new QPropertyAnimation(this, "geometry");
-                animation->setStartValue(QRect(m_current_pos.x(), m_current_pos.y(), m_current_dim.width(), m_current_dim.height()));
-                animation->setEndValue(QRect(m_current_pos.x(), m_current_pos.y(), m_current_dim.width(), h));
-            }
-            else
-                assert(false);
-        }
-        else if(m_orientation == Orientation::Horizontal)
-        {
-            if(m_direction == Direction::Left)
-            {
-                // We are moving the window's origin and resizing at the same time
+    const int count = m_labels.count() + m_batch_adds.count();
+    if(count == 0)
+    {
+        hide();
+        m_current_pos = m_base_pos;
+        m_current_dim = m_base_dim;
+        return;
+    }
 
-                animation = new QPropertyAnimation(this, "geometry");
-                animation->setStartValue(QRect(m_current_pos.x(), m_current_pos.y(), m_current_dim.width(), m_current_dim.height()));
-                animation->setEndValue(QRect(m_current_pos.x() - w_delta, m_current_pos.y(), w, m_current_dim.height()));
+    if(m_base_pos.isNull())
+        initialize_geometry();
 
-                m_current_pos.setX(m_current_pos.x() - w_delta);
-            }
-            else if(m_direction == Direction::Right)
-            {
-                // We are only resizing the window
-                animation = new QPropertyAnimation(this, "geometry");
-                animation->setStartValue(QRect(m_current_pos.x(), m_current_pos.y(), m_current_dim.width(), m_current_dim.height()));
-                animation->setEndValue(QRect(m_current_pos.x(), m_current_pos.y(), w, m_current_dim.height()));
-            }
-            else
-                assert(false);
-        }
+    if(m_labels.isEmpty())
+    {
+        // Nothing is on screen, so there's nothing to animate; start
+        // over from our base geometry
+        m_current_pos = m_base_pos;
+        m_current_dim = m_base_dim;
 
-        if(animation)
+        auto target = layout_geometry(count);
+        if(count > 1)
         {
-            AnimData items{domain, sensor.data(), w, h};
-            m_anim_data[animation] = items;
-
-            animation->setDuration(500);
-            animation->setEasingCurve(QEasingCurve::OutSine);
-            connect(animation, &QAbstractAnimation::finished, this, &Dashboard::slot_add_sensor_animation_complete);
-            m_animation_in_progress = true;
-            animation->start();
+            setGeometry(target);
+            m_current_pos = target.topLeft();
         }
         else
-            assert(false);
+            setGeometry(QRect(m_base_pos, m_base_dim));
+        m_current_dim = target.size();
+
+        add_batch();
+        return;
     }
-    else
-        add_sensor(domain, sensor.data(), w, h);
+
+    auto target = layout_geometry(count);
+
+    if(target == QRect(m_current_pos, m_current_dim))
+    {
+        add_batch();
+        return;
+    }
+
+    // One animation covers the whole batch, however large
+    m_layout_animation = new QPropertyAnimation(this, "geometry");
+    m_layout_animation->setStartValue(QRect(m_current_pos, m_current_dim));
+    m_layout_animation->setEndValue(target);
+    m_layout_animation->setDuration(500);
+    m_layout_animation->setEasingCurve(QEasingCurve::OutSine);
+    connect(m_layout_animation, &QAbstractAnimation::finished, this, &Dashboard::slot_layout_animation_complete);
+
+    m_current_pos = target.topLeft();
+    m_current_dim = target.size();
+
+    m_layout_animation->start();
+}
+
+void Dashboard::slot_layout_animation_complete()
+{
+    m_layout_animation->deleteLater();
+    m_layout_animation = nullptr;
+
+    // New Sensors appear once there is room for them
+    add_batch();
+
+    if(!m_pending_adds.isEmpty() || !m_pending_deletes.isEmpty())
+        schedule_layout();
+}
+
+void Dashboard::add_batch()
+{
+    foreach(const auto& add, m_batch_adds)
+        add_sensor(add.domain_name, add.sensor);
+    m_batch_adds.clear();
+
+    if(!m_labels.isEmpty() && !isVisible())
+        show();
+
+    repaint();
 }
 
-void Dashboard::add_sensor(Domain* domain, Sensor* sensor, int w, int h)
+void Dashboard::add_sensor(const QString& domain_name, SensorPtr sensor)
 {
-    auto tooltip = QString("%1::%2").arg(domain->name(), sensor->name());
+    auto tooltip = QString("%1::%2").arg(domain_name, sensor->name());
 
     auto image = Sensor::StateImages[sensor->state()];
     QPixmap pixmap = (m_orientation == Orientation::Vertical) ? QPixmap(image).scaledToWidth(m_base_dim.width()) : QPixmap(image).scaledToHeight(m_base_dim.height());
 
     auto label = new QLabel();
     label->setPixmap(pixmap);
+    label->installEventFilter(this);
+
+    HistoryCache history;
+    history.sensor = sensor;
+    m_histories[label] = history;
 
     label->setProperty("base_tooltip", tooltip);
-    tooltip = gen_tooltip(sensor, label->property("base_tooltip").toString(), sensor->message());
+    tooltip = gen_tooltip(sensor.data(), label->property("base_tooltip").toString(), sensor->message());
     label->setToolTip(tooltip);
 
     QBoxLayout* my_layout = reinterpret_cast<QBoxLayout*>(layout());
@@ -401,37 +565,36 @@ void Dashboard::add_sensor(Domain* domain, Sensor* sensor, int w, int h)
             assert(false);
     }
 
-    if(m_labels.isEmpty())
-        show();
-
     m_labels[sensor->name()] = label;
-
-    m_current_dim = QSize(w, h);
-
-    repaint();
 }
 
-void Dashboard::animate_del_sensor(SensorPtr sensor)
+void Dashboard::remove_sensor(const QString& name)
 {
-    auto label = m_labels[sensor->name()];
-    m_labels.remove(sensor->name());
+    if(!m_labels.contains(name))
+        return;
 
-    auto my_layout = reinterpret_cast<QVBoxLayout*>(layout());
-    my_layout->takeAt(my_layout->indexOf(label));
-    label->deleteLater();
-
-    if(m_labels.isEmpty())
+    auto label = m_labels.take(name);
+    m_pending_paints.remove(label);
+    m_histories.remove(label);
+    if(m_history_label == label)
     {
-        hide();
-        m_current_pos = m_base_pos;
-        m_current_dim = m_base_dim;
+        m_history_tip->hide();
+        m_history_label = nullptr;
     }
-    else
-        QTimer::singleShot(0, this, &Dashboard::slot_animate_del);
+    if(m_target_sensor == label)
+        m_target_sensor = nullptr;
+
+    auto my_layout = reinterpret_cast<QBoxLayout*>(layout());
+    my_layout->takeAt(my_layout->indexOf(label));
+    label->deleteLater();
 }
 
 void Dashboard::slot_flash_notify()
 {
+    // The label may have been removed mid-flash
+    if(!m_target_sensor)
+        return;
+
     m_flash_count -= 1;
     if(!m_flash_count)
     {
@@ -445,101 +608,3 @@ void Dashboard::slot_flash_notify()
         QTimer::singleShot(100, this, &Dashboard::slot_flash_notify);
     }
 }
-
-void Dashboard::slot_add_sensor_animation_complete()
-{
-    m_animation_in_progress = false;
-
-    auto animation = qobject_cast<QPropertyAnimation*>(sender());
-    animation->deleteLater();
-
-    auto tuple = m_anim_data[animation];
-    m_anim_data.erase(animation);
-
-    auto domain = std::get<0>(tuple);
-    auto sensor = std::get<1>(tuple);
-    auto w = std::get<2>(tuple);
-    auto h = std::get<3>(tuple);
-
-    add_sensor(domain, sensor, w, h);
-}
-
-void Dashboard::slot_animate_del()
-{
-    // Deleting a sensor is done in reverse from adding because we want to visually
-    // remove the avatar from the window first, and THEN animate the window collapsing.
-
-    const int w = (m_orientation == Orientation::Vertical) ? m_current_dim.width() : m_sensor_size * m_labels.count();
-    const int h = (m_orientation == Orientation::Vertical) ? m_sensor_size * m_labels.count() : m_current_dim.height();
-
-    const int w_delta = abs(w - m_current_dim.width());
-    const int h_delta = abs(h - m_current_dim.height());
-
-    // Animate the movement/resizing of the window
-
-    QPropertyAnimation* animation{nullptr};
-    if(m_orientation == Orientation::Vertical)
-    {
-        if(m_direction == Direction::Up)
-        {
-            // We are moving the window's origin and resizing at the same time
-
-            animation = new QPropertyAnimation(this, "geometry");
-            animation->setStartValue(QRect(m_current_pos.x(), m_current_pos.y(), m_current_dim.width(), m_current_dim.height()));
-            animation->setEndValue(QRect(m_current_pos.x(), m_current_pos.y() + h_delta, m_current_dim.width(), h));
-
-            m_current_pos.setY(m_current_pos.y() - h_delta);
-        }
-        else if(m_direction == Direction::Down)
-        {
-            // We are only resizing the window
-
-            animation = new QPropertyAnimation(this, "geometry");
-            animation->setStartValue(QRect(m_current_pos.x(), m_current_pos.y(), m_current_dim.width(), m_current_dim.height()));
-            animation->setEndValue(QRect(m_current_pos.x(), m_current_pos.y(), m_current_dim.width(), h));
-        }
-        else
-            assert(false);
-    }
-    else if(m_orientation == Orientation::Horizontal)
-    {
-        if(m_direction == Direction::Left)
-        {
-            // We are moving the window's origin and resizing at the same time
-
-            animation = new QPropertyAnimation(this, "geometry");
-            animation->setStartValue(QRect(m_current_pos.x(), m_current_pos.y(), m_current_dim.width(), m_current_dim.height()));
-            animation->setEndValue(QRect(m_current_pos.x() + w_delta, m_current_pos.y(), w, m_current_dim.height()));
-
-            m_current_pos.setX(m_current_pos.x() - w_delta);
-        }
-        else if(m_direction == Direction::Right)
-        {
-            // We are only resizing the window
-            animation = new QPropertyAnimation(this, "geometry");
-            animation->setStartValue(QRect(m_current_pos.x(), m_current_pos.y(), m_current_dim.width(), m_current_dim.height()));
-            animation->setEndValue(QRect(m_current_pos.x(), m_current_pos.y(), w, m_current_dim.height()));
-        }
-        else
-            assert(false);
-    }
-
-    if(animation)
-    {
-        animation->setDuration(500);
-        animation->setEasingCurve(QEasingCurve::OutSine);
-        connect(animation, &QAbstractAnimation::finished, this, &Dashboard::slot_del_sensor_animation_complete);
-        m_animation_in_progress = true;
-        animation->start();
-    }
-    else
-        assert(false);
-}
-
-void Dashboard::slot_del_sensor_animation_complete()
-{
-    m_animation_in_progress = false;
-
-    auto animation = qobject_cast<QPropertyAnimation*>(sender());
-    animation->deleteLater();
-}
@@ -1,9 +1,6 @@
 #pragma once
 
-#include <tuple>
-
 #include <QSharedPointer>
-#include <QQueue>
 
 #include <QFrame>
 #include <QLabel>
@@ -56,13 +53,17 @@ public:
 
 signals:
     void        signal_dash_moved(QPoint pos);
+    // A live update to 'sensor' has reached the screen
+    void        signal_sensor_painted(SensorPtr sensor, qint64 painted);
 
 public slots:
     void        slot_add_sensor(SensorPtr sensor, Domain* domain = nullptr);
     void        slot_del_sensor(SensorPtr sensor);
+    void        slot_del_sensors(const SensorList& sensors);
     void        slot_update_sensor(SensorPtr sensor, const QString& message, bool notify);
 
 protected:  // methods
+    bool        eventFilter(QObject* watched, QEvent* event) Q_DECL_OVERRIDE;
     void        paintEvent(QPaintEvent*) Q_DECL_OVERRIDE;
     void        enterEvent(QEvent* event) Q_DECL_OVERRIDE;
     void        leaveEvent(QEvent* event) Q_DECL_OVERRIDE;
@@ -73,31 +74,45 @@ protected:  // methods
 private slots:
     void        slot_flash_notify();
 
-    void        slot_add_sensor_animation_complete();
-    void        animate_sensor_add(SensorPtr sensor, Domain* domain = nullptr);
-    void        slot_del_sensor_animation_complete();
-    void        animate_del_sensor(SensorPtr sensor);
-    void        slot_animate_del();
-
-    void        slot_housekeeping();
+    void        slot_apply_layout();
+    void        slot_layout_animation_complete();
 
 private:    // typedefs and enums
-    enum class SensorAction { None, Add, Delete, Update };
-
     using LabelMap = QMap<QString, QLabel*>;
+    using PaintMap = QMap<QObject*, SensorPtr>;
+
+    // The history timeline drawn for a Sensor's label, kept until the
+    // Sensor records another sample
+    struct HistoryCache
+    {
+        SensorPtr   sensor;
+        quint32     revision{0};
+        QPixmap     image;
+    };
+    using HistoryMap = QMap<QObject*, HistoryCache>;
 
-    using AnimData = std::tuple<Domain*, Sensor*, int, int>;
-    using AnimMap = std::map<QPropertyAnimation*, AnimData>;
-
-    using ActionData = std::tuple<Domain*, SensorPtr, SensorAction>;
-    using ActionQueue = QQueue<ActionData>;
+    static constexpr int history_width{240};
+    static constexpr int history_height{12};
 
-    using TimerPtr = QSharedPointer<QTimer>;
+    // Sensors waiting for the next layout batch
+    struct PendingAdd
+    {
+        QString     domain_name;
+        SensorPtr   sensor;
+    };
+    using AddList = QList<PendingAdd>;
+    using DeleteMap = QMap<QString, SensorPtr>;
 
 private:    // methods
-    void        add_sensor(Domain* domain, Sensor* sensor, int w, int h);
-    void        del_sensor();
+    void        schedule_layout();
+    void        initialize_geometry();
+    QRect       layout_geometry(int count) const;
+    void        add_batch();
+    void        add_sensor(const QString& domain_name, SensorPtr sensor);
+    void        remove_sensor(const QString& name);
     QString     gen_tooltip(Sensor* sensor, const QString& base, const QString& msg = QString());
+    void        show_history_tip(QLabel* label, const QPoint& pos);
+    const QPixmap& history_image(HistoryCache& cache);
 
 private:    // data members
     int         m_margin{15};
@@ -107,6 +122,15 @@ private:    // data members
     Direction   m_direction{Direction::Down};
 
     LabelMap    m_labels;
+    // Labels with an update that has not been painted yet
+    PaintMap    m_pending_paints;
+
+    HistoryMap  m_histories;
+    // Shown in place of a label's tooltip: the tooltip, plus the timeline
+    QFrame*     m_history_tip{nullptr};
+    QLabel*     m_history_text{nullptr};
+    QLabel*     m_history_timeline{nullptr};
+    QObject*    m_history_label{nullptr};
 
     // Our starting geometry; we grow from, or shrink back to,
     // this, depending on the specified orientation
@@ -134,13 +158,15 @@ private:    // data members
     int         m_top_offset{0};
     QPoint      m_start_pos;
 
-    AnimMap     m_anim_data;
-    ActionQueue m_action_queue;
+    // Adds and removes are folded into one target geometry per batch;
+    // changes arriving during an animation wait for the next batch
+    AddList     m_pending_adds;
+    DeleteMap   m_pending_deletes;
+    AddList     m_batch_adds;
+    bool        m_layout_scheduled{false};
+    QPropertyAnimation* m_layout_animation{nullptr};
 
     bool        m_mouse_inside{false};
-    bool        m_animation_in_progress{false};
-
-    TimerPtr    m_housekeeping;
 };
 
 using DashboardPtr = QSharedPointer<Dashboard>;
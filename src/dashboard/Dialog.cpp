@@ -2,17 +2,16 @@
 #include <climits>
 
 #include <QDir>
-#include <QUrl>
 #include <QTimer>
 #include <QMenuBar>
 #include <QDateTime>
 #include <QSettings>
+#include <QFileDialog>
+#include <QHeaderView>
 #include <QStandardPaths>
 
-#include <QJsonDocument>
-#include <QJsonObject>
-
 #include "Dialog.h"
+#include "Trace.h"
 #include "ui_dialog.h"
 
 #include "../SharedTypes.h"
@@ -77,6 +76,29 @@ Dialog::Dialog(QWidget *parent)
 
     load_settings();
 
+    m_model = ModelPtr(new Model());
+    connect(m_model.data(), &Model::signal_domain_added, this, &Dialog::slot_domain_added);
+    connect(m_model.data(), &Model::signal_event, this, &Dialog::slot_model_event);
+    connect(m_model.data(), &Model::signal_domain_removed, this, [this] (std::uint64_t id) { m_latency.forget(id); });
+
+    m_event_log = EventLogPtr(new EventLog());
+    ui->list_Log->setModel(m_event_log.data());
+    connect(m_event_log.data(), &EventLog::rowsInserted, this, &Dialog::slot_log_rows_inserted);
+
+    ui->combo_LogState->addItem(tr("All states"), QString());
+    foreach(const QString& state, QStringList() << "healthy" << "poor" << "critical" << "deceased" << "offline" << "warning")
+        ui->combo_LogState->addItem(state.at(0).toUpper() + state.mid(1), state);
+    connect(ui->line_LogDomain, &QLineEdit::textChanged, this, &Dialog::slot_log_filter_changed);
+    connect(ui->line_LogSensor, &QLineEdit::textChanged, this, &Dialog::slot_log_filter_changed);
+    connect(ui->combo_LogState, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &Dialog::slot_log_filter_changed);
+
+    ui->tree_Latency->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    connect(ui->button_Latency_Export, &QPushButton::clicked, this, &Dialog::slot_export_latency);
+    m_latency_refresh.setInterval(latency_refresh_interval);
+    connect(&m_latency_refresh, &QTimer::timeout, this, &Dialog::slot_refresh_latency);
+    connect(&m_latency_refresh, &QTimer::timeout, this, &Dialog::slot_refresh_memory);
+    m_latency_refresh.start();
+
     m_trayIcon = new QSystemTrayIcon(this);
     connect(m_trayIcon, &QSystemTrayIcon::messageClicked, this, &Dialog::slot_tray_message_clicked);
     connect(m_trayIcon, &QSystemTrayIcon::activated, this, &Dialog::slot_tray_icon_activated);
@@ -103,6 +125,7 @@ void Dialog::slot_test_insert_sensor()
         auto domain = DomainPtr(new Domain(123456789, "corrin"));
         connect(domain.data(), &Domain::signal_sensor_added, m_dashboard.data(), &Dashboard::slot_add_sensor);
         connect(domain.data(), &Domain::signal_sensor_removed, m_dashboard.data(), &Dashboard::slot_del_sensor);
+        connect(domain.data(), &Domain::signal_sensors_removed, m_dashboard.data(), &Dashboard::slot_del_sensors);
         connect(domain.data(), &Domain::signal_sensor_updated, m_dashboard.data(), &Dashboard::slot_update_sensor);
 
         m_domains[domain->id()] = domain;
@@ -140,7 +163,8 @@ void Dialog::slot_test_critical_sensor()
 void Dialog::slot_test_remove_sensor()
 {
     // Test the "offline" state
-    // ("offline" sensors will be cleared automatically after a delay)
+    // (the Model clears "offline" sensors after a delay; this Domain is
+    // not in the Model, so the sensor stays)
     m_domains[123456789]->update_sensor(QString("reactor_monitor_%1").arg(m_test_count - 1), SharedTypes::SensorState::Offline);
     // m_domains[123456789]->del_sensor(QString("reactor_monitor_%1").arg(m_test_count - 1));
 }
@@ -155,6 +179,22 @@ void Dialog::closeEvent(QCloseEvent* event)
     }
 }
 
+void Dialog::showEvent(QShowEvent* event)
+{
+    // Catch up on everything logged while hidden, in one go
+    m_event_log->set_live(true);
+    ui->list_Log->scrollToBottom();
+
+    QDialog::showEvent(event);
+}
+
+void Dialog::hideEvent(QHideEvent* event)
+{
+    m_event_log->set_live(false);
+
+    QDialog::hideEvent(event);
+}
+
 void Dialog::build_tray_menu()
 {
     if (m_trayIconMenu)
@@ -346,7 +386,13 @@ void Dialog::slot_multicast_group_join()
 
         m_multicast_sender.clear();
         m_multicast_receiver.clear();
+        m_priority_receiver.clear();
         m_dashboard.clear();
+
+        // The next Dashboard starts from a clean slate; Collectors
+        // will repopulate it when we rejoin
+        m_model->clear();
+        m_latency.clear();
     }
     else
     {
@@ -358,6 +404,7 @@ void Dialog::slot_multicast_group_join()
         );
         m_dashboard->setGeometry(QRect(m_dash_pos.x(), m_dash_pos.y(), base_symmetry, base_symmetry));
         connect(m_dashboard.data(), &Dashboard::signal_dash_moved, this, &Dialog::slot_dash_moved);
+        connect(m_dashboard.data(), &Dashboard::signal_sensor_painted, this, &Dialog::slot_sensor_painted);
 
         ui->button_Channels_Join->setText(tr("Leave"));
 
@@ -382,6 +429,15 @@ void Dialog::slot_multicast_group_join()
                 ipv6_multcast_group = ui->line_MulticastGroupIPv6->placeholderText();
         }
 
+        if(!m_topic.isEmpty())
+        {
+            if(ui->check_Channels_IPv4->isChecked())
+                ipv4_multcast_group = SharedTypes::topic_group_ipv4(m_topic);
+            if(ui->check_Channels_IPv6->isChecked())
+                ipv6_multcast_group = SharedTypes::topic_group_ipv6(m_topic);
+            slot_model_event(tr("Dashboard"), tr("topic"), tr("%1 (%2)").arg(m_topic, ipv4_multcast_group.isEmpty() ? ipv6_multcast_group : ipv4_multcast_group));
+        }
+
         if (m_randomized_addresses && (!ui->line_MulticastGroupIPv4->text().isEmpty() || !ui->line_MulticastGroupIPv6->text().isEmpty()))
         {
             QMessageBox::warning(
@@ -397,6 +453,23 @@ void Dialog::slot_multicast_group_join()
         m_multicast_sender.reset(new Sender(group_port, ipv4_multcast_group, ipv6_multcast_group, this));
         m_multicast_receiver.reset(new Receiver(group_port, ipv4_multcast_group, ipv6_multcast_group, this));
         connect(m_multicast_receiver.data(), &Receiver::signal_datagram_available, this, &Dialog::slot_process_peer_event);
+        if(m_subscription && !m_subscription->is_empty())
+            m_multicast_receiver->set_subscription(m_subscription);
+
+        if(!m_priority_group.isEmpty())
+        {
+            auto priority_port = m_priority_port ? m_priority_port : static_cast<quint16>(group_port + 1);
+            auto is_ipv6 = QHostAddress(m_priority_group).protocol() == QAbstractSocket::IPv6Protocol;
+            m_priority_receiver.reset(new Receiver(priority_port, is_ipv6 ? QString() : m_priority_group,
+                                                   is_ipv6 ? m_priority_group : QString(), this));
+            connect(m_priority_receiver.data(), &Receiver::signal_datagram_available, this, &Dialog::slot_process_peer_event);
+            if(m_subscription && !m_subscription->is_empty())
+                m_priority_receiver->set_subscription(m_subscription);
+            m_multicast_receiver->set_priority(m_priority_receiver);
+        }
+
+        if(!m_capture_file.isEmpty() && !m_multicast_receiver->set_capture(m_capture_file))
+            QMessageBox::warning(this, tr("Capture"), tr("Unable to record ring traffic to \"%1\".").arg(m_capture_file));
 
         // Request an update from any Collectors in the multicast group
         auto dashboard_online = QString("{ \"dashboard_id\" : \"%1\", \"action\" : \"initialize\" }")
@@ -415,111 +488,113 @@ void Dialog::slot_multicast_group_join()
 
 void Dialog::slot_process_peer_event(const QByteArray& datagram)
 {
-    while(ui->list_Log->count() > 50)
-        ui->list_Log->takeItem(0);
+    TRACE_SPAN("Dialog::slot_process_peer_event");
 
-    auto doc{QJsonDocument::fromJson(datagram)};
-    if(!doc.isNull())
-    {
-        QJsonObject object = doc.object();
+    m_model->process_datagram(datagram);
+}
+
+void Dialog::slot_domain_added(Domain* domain)
+{
+    connect(domain, &Domain::signal_sensor_added, m_dashboard.data(), &Dashboard::slot_add_sensor);
+    connect(domain, &Domain::signal_sensor_removed, m_dashboard.data(), &Dashboard::slot_del_sensor);
+    connect(domain, &Domain::signal_sensors_removed, m_dashboard.data(), &Dashboard::slot_del_sensors);
+    connect(domain, &Domain::signal_sensor_updated, m_dashboard.data(), &Dashboard::slot_update_sensor);
+}
 
-        // Only process events from Collectors
-        if(object.contains("domain_id") && object.contains("type"))
+void Dialog::slot_model_event(const QString& domain_name, const QString& sensor_name, const QString& detail)
+{
+    m_event_log->append(domain_name, sensor_name, detail);
+}
+
+void Dialog::slot_log_filter_changed()
+{
+    m_event_log->set_filter(ui->line_LogDomain->text(),
+                            ui->line_LogSensor->text(),
+                            ui->combo_LogState->currentData().toString());
+    ui->list_Log->scrollToBottom();
+}
+
+void Dialog::slot_log_rows_inserted()
+{
+    // Follow the newest events unless the user has picked one out; once
+    // per burst rather than once per event
+    if(m_log_scroll_pending || ui->list_Log->selectionModel()->hasSelection())
+        return;
+
+    m_log_scroll_pending = true;
+    QTimer::singleShot(0, this, [this] () {
+        m_log_scroll_pending = false;
+        ui->list_Log->scrollToBottom();
+    });
+}
+
+void Dialog::slot_sensor_painted(SensorPtr sensor, qint64 painted)
+{
+    auto stamp = sensor->take_latency_stamp();
+    if(!stamp.is_valid())
+        return;
+
+    auto domain_name = m_model->domain_name(stamp.domain_id);
+    m_latency.record(stamp, painted, domain_name.isEmpty() ? QString::number(stamp.domain_id) : domain_name);
+}
+
+void Dialog::slot_refresh_latency()
+{
+    auto summaries = m_latency.summaries();
+
+    if(isVisible())
+    {
+        ui->tree_Latency->clear();
+        foreach(const auto& summary, summaries)
         {
-            assert(object.contains("domain_name"));
-
-            auto msg_type = SharedTypes::MsgText2Type[object["type"].toString()];
-            auto domain_id = reinterpret_cast<uint64_t>(object["domain_id"].toString().toULong());
-            auto domain_name = QUrl::fromPercentEncoding(object["domain_name"].toString().toUtf8());
-
-            if(!m_domains.contains(domain_id))
-            {
-                auto domain = DomainPtr(new Domain(domain_id, domain_name));
-                connect(domain.data(), &Domain::signal_sensor_added, m_dashboard.data(), &Dashboard::slot_add_sensor);
-                connect(domain.data(), &Domain::signal_sensor_removed, m_dashboard.data(), &Dashboard::slot_del_sensor);
-                connect(domain.data(), &Domain::signal_sensor_updated, m_dashboard.data(), &Dashboard::slot_update_sensor);
-
-                m_domains[domain->id()] = domain;
-            }
-
-            auto domain = m_domains[domain_id];
-
-            switch(msg_type)
-            {
-                case SharedTypes::MessageType::Sensor:
-                    assert(object.contains("sensor_name"));
-                    assert(object.contains("sensor_state"));
-                    assert(object.contains("sensor_message"));
-
-                    {
-                        auto sensor_name = QUrl::fromPercentEncoding(object["sensor_name"].toString().toUtf8());
-                        auto sensor_state = object["sensor_state"].toString().toLower();
-                        auto sensor_message = object["sensor_message"].toString();
-
-                        auto updated = QDateTime::currentDateTime();
-                        if(object.contains("updated"))
-                            updated = QDateTime::fromMSecsSinceEpoch(object["updated"].toString().toLongLong());
-
-                        if(!domain->has_sensor(sensor_name))
-                        {
-                            auto sensor = SensorPtr(new Sensor(sensor_name));
-                            sensor->set_state(SharedTypes::MsgText2State[sensor_state], sensor_message);
-                            sensor->set_update(updated);
-                            domain->add_sensor(sensor);
-                        }
-                        else
-                            domain->update_sensor(sensor_name, SharedTypes::MsgText2State[sensor_state], updated, sensor_message);
-
-                        ui->list_Log->addItem(
-                            QString("%1: %2::%3::%4")
-                                .arg(QDateTime::currentDateTime().toString(), domain_name, sensor_name, sensor_state)
-                        );
-                    }
-                    break;
-
-                case SharedTypes::MessageType::Offline:
-                    // TODO: Multiple Sensors closing at the same time on the same Domain cause the dashboard to crash.
-                    assert(object.contains("sensor_name"));
-                    // Sensor has gone offline
-                    {
-                        auto sensor_name = QUrl::fromPercentEncoding(object["sensor_name"].toString().toUtf8());
-                        assert(domain->has_sensor(sensor_name));
-                        QString sensor_message;
-                        if(object.contains("sensor_message"))
-                            sensor_message = object["sensor_message"].toString();
-
-                        domain->update_sensor(sensor_name, SharedTypes::SensorState::Offline, QDateTime::currentDateTime(), sensor_message);
-
-                        ui->list_Log->addItem(
-                            QString("%1: %2::%3::Offline")
-                                .arg(QDateTime::currentDateTime().toString(), domain_name, sensor_name)
-                        );
-                    }
-                    break;
-
-                case SharedTypes::MessageType::Warning:
-                    assert(object.contains("sensor_name"));
-                    assert(object.contains("domain_warning"));
-                    // A warning of some type
-                    {
-                        auto sensor_name = QUrl::fromPercentEncoding(object["sensor_name"].toString().toUtf8());
-                        auto domain_warning = object["domain_warning"].toString();
-
-                        ui->list_Log->addItem(
-                            QString("%1: %2::%3::Warning::%4")
-                                .arg(QDateTime::currentDateTime().toString(), domain_name, sensor_name, domain_warning)
-                        );
-                    }
-                case SharedTypes::MessageType::Error:
-                    // An error of some type
-                    break;
-            }
+            auto item = new QTreeWidgetItem(ui->tree_Latency);
+            item->setText(0, summary.domain_name);
+            item->setText(1, QString::number(summary.samples));
+            item->setText(2, QString::number(summary.total_p50));
+            item->setText(3, QString::number(summary.total_p99));
+            item->setText(4, QString("%1 / %2 / %3").arg(summary.collector_p50).arg(summary.network_p50).arg(summary.display_p50));
         }
     }
 
-    auto selected = ui->list_Log->selectedItems();
-    if(selected.count() == 0)
-        ui->list_Log->scrollToBottom();
+    if(!m_latency_file.isEmpty() && !summaries.isEmpty())
+        m_latency.export_csv(m_latency_file);
+}
+
+void Dialog::slot_refresh_memory()
+{
+    if(!isVisible())
+        return;
+
+    ui->label_Memory->setText(tr("%1 Domains, %2 Sensors, about %3 KiB (%4 Domains and %5 Sensors evicted)")
+                                .arg(m_model->domain_count())
+                                .arg(m_model->sensor_count())
+                                .arg(m_model->memory_estimate() / 1024)
+                                .arg(m_model->evicted_domains())
+                                .arg(m_model->evicted_sensors()));
+
+    if(m_subscription && !m_subscription->is_empty())
+        ui->label_Subscription->setText(tr("%1 datagrams outside the subscription dropped before decoding, %2 accepted")
+                                        .arg(m_subscription->dropped())
+                                        .arg(m_subscription->accepted()));
+
+    auto reports = m_model->reports_checked();
+    if(reports)
+        ui->label_Repeats->setText(tr("%1 of %2 Sensor reports were repeats and dropped (%3%)")
+                                    .arg(m_model->repeats_dropped())
+                                    .arg(reports)
+                                    .arg(100.0 * m_model->repeats_dropped() / reports, 0, 'f', 1));
+}
+
+void Dialog::slot_export_latency()
+{
+    auto path = QFileDialog::getSaveFileName(this, tr("Export Latency"),
+                                             QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation),
+                                             tr("CSV files (*.csv)"));
+    if(path.isEmpty())
+        return;
+
+    if(!m_latency.export_csv(path))
+        QMessageBox::warning(this, tr("Export Latency"), tr("Unable to write \"%1\".").arg(path));
 }
 
 void Dialog::slot_randomize_ipv4()
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QMap>
+#include <QTimer>
 #include <QList>
 #include <QMenu>
 #include <QAction>
@@ -8,16 +9,20 @@
 #include <QByteArray>
 #include <QMessageBox>
 #include <QShowEvent>
+#include <QHideEvent>
 #include <QCloseEvent>
 #include <QSystemTrayIcon>
 
 #include "Dashboard.h"
-#include "Domain.h"
+#include "EventLog.h"
+#include "Model.h"
 #include "Sender.h"
 #include "Receiver.h"
 
 // This is the initial width/height of the dashboard window.
 constexpr int base_symmetry{75};
+// How often the latency summary (and memory readout) is refreshed, and the summary exported
+constexpr int latency_refresh_interval{5000};
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -33,8 +38,32 @@ public:
     Dialog(QWidget *parent = nullptr);
     ~Dialog();
 
+    // Record ring traffic to 'path' whenever we're a group member
+    void        set_capture_file(const QString& path) { m_capture_file = path; }
+    // Rewrite the latency summary to 'path' as it is refreshed
+    void        set_latency_file(const QString& path) { m_latency_file = path; }
+
+    // Limits on what the model keeps (see Model)
+    void        set_domain_idle(int minutes) { m_model->set_idle_timeout(minutes * 60); }
+    void        set_max_domains(int max) { m_model->set_max_domains(max); }
+    void        set_max_sensors(int max) { m_model->set_max_sensors(max); }
+
+    // Only decode the traffic 'subscription' accepts
+    void        set_subscription(SubscriptionPtr subscription) { m_subscription = subscription; }
+    // Join the groups derived from 'topic' instead of the configured ones
+    void        set_topic(const QString& topic) { m_topic = topic; }
+
+    // Also join the group Collectors send Critical and Deceased transitions
+    // to, and always handle its traffic first
+    void        set_priority_group(const QString& address, quint16 port) { m_priority_group = address; m_priority_port = port; }
+
+    // How many events the log keeps
+    void        set_log_history(int events) { m_event_log->set_capacity(events); }
+
 protected: // methods
     void        closeEvent(QCloseEvent *event);
+    void        showEvent(QShowEvent *event);
+    void        hideEvent(QHideEvent *event);
 
 private slots:
     void        slot_set_control_states();
@@ -46,6 +75,14 @@ private slots:
     void        slot_tray_menu_action(QAction* action);
 
     void        slot_process_peer_event(const QByteArray& datagram);
+    void        slot_domain_added(Domain* domain);
+    void        slot_model_event(const QString& domain_name, const QString& sensor_name, const QString& detail);
+    void        slot_log_filter_changed();
+    void        slot_log_rows_inserted();
+    void        slot_sensor_painted(SensorPtr sensor, qint64 painted);
+    void        slot_refresh_latency();
+    void        slot_export_latency();
+    void        slot_refresh_memory();
 
     void        slot_randomize_ipv4();
     void        slot_randomize_ipv6();
@@ -69,8 +106,10 @@ private slots:
     void        slot_test_remove_sensor();
 #endif
 
+#ifdef TEST
 private:    // typedefs and emums
     using DomainMap = QMap<uint64_t, DomainPtr>;
+#endif
 
 private:    // methods
     void        build_tray_menu();
@@ -89,12 +128,21 @@ private:    // data members
 
     SenderPtr   m_multicast_sender;
     ReceiverPtr m_multicast_receiver;
+    ReceiverPtr m_priority_receiver;
 
     bool        m_multicast_group_member{false};
     bool        m_randomized_addresses{false};
 
-    // List of domains we've heard from
-    DomainMap   m_domains;
+    // Domains and Sensors we've heard from
+    ModelPtr    m_model;
+
+    // Recent events, shown in the log while the dialog is visible
+    EventLogPtr m_event_log;
+    bool        m_log_scroll_pending{false};
+
+    // How long state changes take to reach the screen
+    LatencyTracker m_latency;
+    QTimer      m_latency_refresh;
 
     QPoint      m_dash_pos;
 
@@ -103,7 +151,17 @@ private:    // data members
 
     QString     m_version;
 
+    QString     m_capture_file;
+    QString     m_latency_file;
+
+    SubscriptionPtr m_subscription;
+    QString     m_topic;
+
+    QString     m_priority_group;
+    quint16     m_priority_port{0};
+
 #ifdef TEST
+    DomainMap   m_domains;
     int         m_test_count{0};
 #endif
 };
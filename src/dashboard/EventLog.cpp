@@ -0,0 +1,102 @@
+#include <QDateTime>
+
+#include "EventLog.h"
+
+EventLog::EventLog(int capacity, QObject* parent)
+    : QAbstractListModel{parent},
+      m_events(static_cast<size_t>(qMax(1, capacity)))
+{}
+
+void EventLog::set_capacity(int capacity)
+{
+    beginResetModel();
+    m_events.assign(static_cast<size_t>(qMax(1, capacity)), Event());
+    m_next = 0;
+    m_rows.clear();
+    endResetModel();
+}
+
+void EventLog::set_live(bool live)
+{
+    if(live == m_live)
+        return;
+
+    m_live = live;
+    if(m_live)
+        rebuild();
+}
+
+void EventLog::set_filter(const QString& domain, const QString& sensor, const QString& state)
+{
+    m_domain_filter = domain;
+    m_sensor_filter = sensor;
+    m_state_filter = state;
+
+    if(m_live)
+        rebuild();
+}
+
+void EventLog::append(const QString& domain_name, const QString& sensor_name, const QString& detail)
+{
+    auto sequence = m_next++;
+    const auto capacity = static_cast<quint64>(m_events.size());
+
+    // The oldest event makes way for this one
+    if(m_live && sequence >= capacity && !m_rows.empty() && m_rows.front() == sequence - capacity)
+    {
+        beginRemoveRows(QModelIndex(), 0, 0);
+        m_rows.pop_front();
+        endRemoveRows();
+    }
+
+    auto& slot = m_events[sequence % capacity];
+    slot.when = QDateTime::currentMSecsSinceEpoch();
+    slot.domain_name = domain_name;
+    slot.sensor_name = sensor_name;
+    slot.detail = detail;
+
+    if(!m_live || !matches(slot))
+        return;
+
+    auto row = static_cast<int>(m_rows.size());
+    beginInsertRows(QModelIndex(), row, row);
+    m_rows.push_back(sequence);
+    endInsertRows();
+}
+
+int EventLog::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(m_rows.size());
+}
+
+QVariant EventLog::data(const QModelIndex& index, int role) const
+{
+    if(role != Qt::DisplayRole || !index.isValid() || index.row() >= static_cast<int>(m_rows.size()))
+        return QVariant();
+
+    const auto& e = event(m_rows[static_cast<size_t>(index.row())]);
+    return QString("%1: %2::%3::%4")
+            .arg(QDateTime::fromMSecsSinceEpoch(e.when).toString(), e.domain_name, e.sensor_name, e.detail);
+}
+
+bool EventLog::matches(const Event& event) const
+{
+    return (m_domain_filter.isEmpty() || event.domain_name.contains(m_domain_filter, Qt::CaseInsensitive)) &&
+           (m_sensor_filter.isEmpty() || event.sensor_name.contains(m_sensor_filter, Qt::CaseInsensitive)) &&
+           (m_state_filter.isEmpty() || event.detail.startsWith(m_state_filter, Qt::CaseInsensitive));
+}
+
+void EventLog::rebuild()
+{
+    beginResetModel();
+
+    m_rows.clear();
+    const auto capacity = static_cast<quint64>(m_events.size());
+    for(auto sequence = m_next > capacity ? m_next - capacity : 0;sequence < m_next;++sequence)
+    {
+        if(matches(event(sequence)))
+            m_rows.push_back(sequence);
+    }
+
+    endResetModel();
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include <QString>
+#include <QSharedPointer>
+#include <QAbstractListModel>
+
+// Events kept for the log unless told otherwise
+constexpr int default_log_history{1000};
+
+//---------------------------------------------------------------------------
+// EventLog
+//
+// The Dashboard's event log: a fixed number of the most recent events in a
+// ring, shown through a list model that formats a row only when a view asks
+// for it.  Adding an event costs the same however long the history is.
+//
+// Rows are the events that pass the current filter.  While the log is not
+// live (nobody is looking), events go into the ring and nothing else
+// happens; going live rebuilds the rows once.
+//---------------------------------------------------------------------------
+
+class EventLog : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit EventLog(int capacity = default_log_history, QObject* parent = nullptr);
+
+    // Discards the history
+    void        set_capacity(int capacity);
+    int         capacity() const { return static_cast<int>(m_events.size()); }
+
+    void        set_live(bool live);
+    bool        is_live() const { return m_live; }
+
+    // Substring matches, ignoring case; empty matches everything.  'state'
+    // matches the start of the event's detail (e.g., "critical", "warning").
+    void        set_filter(const QString& domain, const QString& sensor, const QString& state);
+
+    void        append(const QString& domain_name, const QString& sensor_name, const QString& detail);
+
+    int         rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant    data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+private:    // typedefs and enums
+    struct Event
+    {
+        qint64      when{0};
+        QString     domain_name;
+        QString     sensor_name;
+        QString     detail;
+    };
+
+private:    // methods
+    const Event& event(quint64 sequence) const { return m_events[sequence % m_events.size()]; }
+    bool        matches(const Event& event) const;
+    void        rebuild();
+
+private:    // data members
+    std::vector<Event>  m_events;
+    // Sequence number the next event will have; event 's' lives in
+    // m_events[s % capacity] until 's + capacity' replaces it
+    quint64     m_next{0};
+
+    // Sequence numbers of the events passing the filter, oldest first
+    std::deque<quint64> m_rows;
+
+    bool        m_live{false};
+
+    QString     m_domain_filter;
+    QString     m_sensor_filter;
+    QString     m_state_filter;
+};
+
+using EventLogPtr = QSharedPointer<EventLog>;
@@ -22,26 +22,41 @@ win32 {
 
 #DEFINES += TEST
 
-INCLUDEPATH += ../common ../common/network
+# Trace spans (see common/Trace.h) are compiled in with: qmake "DEFINES+=DASHD_TRACE"
+
+# Codec compresses datagrams with zlib: the system's on Unix, and on
+# Windows the copy built into QtCore
+unix: LIBS += -lz
+win32: QT += zlib-private
+
+INCLUDEPATH += ../common ../common/network ../model
+
+# Domain, Sensor and Model live in the headless model library
+LIBS += -L$$OUT_PWD/../model -ldashd-model
+win32: PRE_TARGETDEPS += $$OUT_PWD/../model/dashd-model.lib
+else: PRE_TARGETDEPS += $$OUT_PWD/../model/libdashd-model.a
 
 SOURCES += \
-    ../common/SharedTypes.cpp \
+    ../common/network/Capture.cpp \
+    ../common/network/Codec.cpp \
     ../common/network/Receiver.cpp \
     ../common/network/Sender.cpp \
+    ../common/network/Subscription.cpp \
     Dashboard.cpp \
-    Domain.cpp \
-    Sensor.cpp \
+    EventLog.cpp \
     main.cpp \
     Dialog.cpp
 
 HEADERS += \
     ../common/SharedTypes.h \
+    ../common/network/Capture.h \
+    ../common/network/Codec.h \
     ../common/network/Receiver.h \
     ../common/network/Sender.h \
+    ../common/network/Subscription.h \
     Dashboard.h \
-    Domain.h \
-    Sensor.h \
-    Dialog.h
+    Dialog.h \
+    EventLog.h
 
 FORMS += \
     dialog.ui
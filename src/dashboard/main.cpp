@@ -1,6 +1,11 @@
 #include "Dialog.h"
+#include "Trace.h"
+#include "Subscription.h"
 
+#include <QDir>
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
 
 int main(int argc, char *argv[])
 {
@@ -9,12 +14,117 @@ int main(int argc, char *argv[])
 #endif
     QApplication a(argc, argv);
 
+    // With tracing built in, SIGUSR1 dumps the trace rings to the temp folder
+    TRACE_INSTALL_DUMP_SIGNAL(QDir::tempPath(), &a);
+
     if (!QSystemTrayIcon::isSystemTrayAvailable())
     {
         QMessageBox::critical(nullptr, QObject::tr("Dash'd"), QObject::tr("I couldn't detect any system tray on this system."));
         return 1;
     }
 
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QObject::tr("Dash'd Dashboard"));
+    parser.addHelpOption();
+
+    QCommandLineOption captureOption(QStringList() << "capture",
+            QObject::tr("Record every datagram heard on the ring to <file> (see the replay tool)."),
+            QObject::tr("file"));
+    parser.addOption(captureOption);
+
+    QCommandLineOption latencyOption(QStringList() << "latency-file",
+            QObject::tr("Keep <file> updated with per-Domain latency percentiles (CSV)."),
+            QObject::tr("file"));
+    parser.addOption(latencyOption);
+
+    QCommandLineOption domainIdleOption(QStringList() << "domain-idle",
+            QObject::tr("Forget Domains not heard from in <minutes> (0 keeps them; default 60)."),
+            QObject::tr("minutes"));
+    parser.addOption(domainIdleOption);
+
+    QCommandLineOption maxDomainsOption(QStringList() << "max-domains",
+            QObject::tr("Track at most <count> Domains, forgetting the least recently heard (0 for no limit; default 1000)."),
+            QObject::tr("count"));
+    parser.addOption(maxDomainsOption);
+
+    QCommandLineOption maxSensorsOption(QStringList() << "max-sensors",
+            QObject::tr("Track at most <count> Sensors, forgetting the least recently heard (0 for no limit; default 25000)."),
+            QObject::tr("count"));
+    parser.addOption(maxSensorsOption);
+
+    QCommandLineOption logHistoryOption(QStringList() << "log-history",
+            QObject::tr("Keep the most recent <count> events in the settings dialog's log (default %1).").arg(default_log_history),
+            QObject::tr("count"));
+    parser.addOption(logHistoryOption);
+
+    QCommandLineOption topicOption(QStringList() << "topic",
+            QObject::tr("Join the multicast group derived from <topic> (as Collectors started with the same --topic do)."),
+            QObject::tr("topic"));
+    parser.addOption(topicOption);
+
+    QCommandLineOption priorityGroupOption(QStringList() << "priority-group",
+            QObject::tr("Also join the multicast group at <address> that Collectors send Critical and Deceased transitions to, and handle it first."),
+            QObject::tr("address"));
+    parser.addOption(priorityGroupOption);
+
+    QCommandLineOption priorityPortOption(QStringList() << "priority-port",
+            QObject::tr("Port of the priority group (default: the group port plus one)."),
+            QObject::tr("port"));
+    parser.addOption(priorityPortOption);
+
+    QCommandLineOption domainsOption(QStringList() << "domains",
+            QObject::tr("Only show Domains whose names match one of these comma-separated <globs> (e.g., \"web-*,db?\")."),
+            QObject::tr("globs"));
+    parser.addOption(domainsOption);
+
+    QCommandLineOption sensorsOption(QStringList() << "sensors",
+            QObject::tr("Only show Sensors whose names start with one of these comma-separated <prefixes>."),
+            QObject::tr("prefixes"));
+    parser.addOption(sensorsOption);
+
+    QCommandLineOption minStateOption(QStringList() << "min-state",
+            QObject::tr("Only show Sensors reporting <state> (poor, critical or deceased) or worse."),
+            QObject::tr("state"));
+    parser.addOption(minStateOption);
+
+    parser.process(a);
+
     Dialog w;
+    if(parser.isSet(captureOption))
+        w.set_capture_file(parser.value(captureOption));
+    if(parser.isSet(latencyOption))
+        w.set_latency_file(parser.value(latencyOption));
+    if(parser.isSet(topicOption))
+        w.set_topic(parser.value(topicOption));
+
+    if(parser.isSet(priorityGroupOption))
+        w.set_priority_group(parser.value(priorityGroupOption),
+                             parser.isSet(priorityPortOption) ? parser.value(priorityPortOption).toUShort() : 0);
+
+    auto subscription = SubscriptionPtr(new Subscription());
+    if(parser.isSet(domainsOption))
+        subscription->set_domains(parser.value(domainsOption).split(','));
+    if(parser.isSet(sensorsOption))
+        subscription->set_sensors(parser.value(sensorsOption).split(','));
+    if(parser.isSet(minStateOption))
+    {
+        auto state = SharedTypes::MsgText2State.value(parser.value(minStateOption).toLower(), SharedTypes::SensorState::Undefined);
+        if(state == SharedTypes::SensorState::Undefined || state == SharedTypes::SensorState::Offline)
+        {
+            QMessageBox::critical(nullptr, QObject::tr("Dash'd"), QObject::tr("--min-state must be healthy, poor, critical or deceased."));
+            return 1;
+        }
+        subscription->set_minimum_state(state);
+    }
+    w.set_subscription(subscription);
+
+    if(parser.isSet(logHistoryOption))
+        w.set_log_history(parser.value(logHistoryOption).toInt());
+    if(parser.isSet(domainIdleOption))
+        w.set_domain_idle(parser.value(domainIdleOption).toInt());
+    if(parser.isSet(maxDomainsOption))
+        w.set_max_domains(parser.value(maxDomainsOption).toInt());
+    if(parser.isSet(maxSensorsOption))
+        w.set_max_sensors(parser.value(maxSensorsOption).toInt());
     return a.exec();
 }
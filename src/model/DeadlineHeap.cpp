@@ -0,0 +1,24 @@
+#include <algorithm>
+
+#include "DeadlineHeap.h"
+
+namespace
+{
+    // std::*_heap keep the largest on top; we want the soonest
+    bool later(const DeadlineHeap::Entry& lhs, const DeadlineHeap::Entry& rhs)
+    {
+        return lhs.deadline > rhs.deadline;
+    }
+}
+
+void DeadlineHeap::push(qint64 deadline, quint32 row, quint32 epoch)
+{
+    m_entries.push_back(Entry{deadline, row, epoch});
+    std::push_heap(m_entries.begin(), m_entries.end(), later);
+}
+
+void DeadlineHeap::pop()
+{
+    std::pop_heap(m_entries.begin(), m_entries.end(), later);
+    m_entries.pop_back();
+}
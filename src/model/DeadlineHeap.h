@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+
+#include <QtGlobal>
+
+//---------------------------------------------------------------------------
+// DeadlineHeap
+//
+// A min-heap of deadlines, each naming a table row and the row's epoch at
+// the time it was scheduled.  Entries are never cancelled; whoever pops one
+// compares its epoch with the row's current one and ignores it if the row
+// has moved on.
+//---------------------------------------------------------------------------
+
+class DeadlineHeap
+{
+public:     // typedefs and enums
+    struct Entry
+    {
+        qint64      deadline{0};    // milliseconds since the epoch
+        quint32     row{0};
+        quint32     epoch{0};
+    };
+
+public:
+    DeadlineHeap() = default;
+
+    void        push(qint64 deadline, quint32 row, quint32 epoch);
+    // The earliest deadline; the heap must not be empty
+    const Entry& top() const { return m_entries.front(); }
+    void        pop();
+
+    bool        isEmpty() const { return m_entries.empty(); }
+    int         count() const { return static_cast<int>(m_entries.size()); }
+    qint64      memory_estimate() const { return static_cast<qint64>(m_entries.capacity() * sizeof(Entry)); }
+
+    void        clear() { m_entries.clear(); }
+
+private:    // data members
+    std::vector<Entry> m_entries;
+};
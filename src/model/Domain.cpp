@@ -0,0 +1,81 @@
+#include "Domain.h"
+#include "Trace.h"
+
+Domain::Domain(std::uint64_t id, const QString& name, QObject *parent)
+    : QObject{parent},
+      m_id(id),
+      m_name(name)
+{}
+
+Domain::~Domain()
+{
+    if(!m_sensors.isEmpty())
+        emit signal_sensors_removed(m_sensors.values());
+}
+
+void Domain::add_sensor(SensorPtr sensor)
+{
+    m_sensors[sensor->name()] = sensor;
+    emit signal_sensor_added(sensor, this);
+}
+
+void Domain::del_sensor(const QString& name)
+{
+    auto sensor = m_sensors[name];
+    m_sensors.remove(name);
+
+    emit signal_sensor_removed(sensor);
+}
+
+void Domain::del_sensors(const QStringList& names)
+{
+    SensorList sensors;
+    foreach(const QString& name, names)
+    {
+        if(m_sensors.contains(name))
+            sensors.append(m_sensors.take(name));
+    }
+
+    if(!sensors.isEmpty())
+        emit signal_sensors_removed(sensors);
+}
+
+void Domain::update_sensor(QString name, SharedTypes::SensorState state, const QDateTime& update, const QString& message)
+{
+    TRACE_SPAN("Domain::update_sensor");
+
+    // Do we have this sensor already?
+    assert(m_sensors.contains(name));
+    auto sensor = m_sensors[name];
+
+    bool notify = state > sensor->state();
+    sensor->set_state(state, message);
+    sensor->set_update(update);
+    emit signal_sensor_updated(sensor, message, notify);
+}
+
+void Domain::set_offline()
+{
+    auto now = QDateTime::currentDateTime();
+    foreach(SensorPtr sensor, m_sensors)
+    {
+        if(sensor->state() == SharedTypes::SensorState::Offline)
+            continue;
+
+        sensor->set_state(SharedTypes::SensorState::Offline);
+        sensor->set_update(now);
+        // No flashing: nothing here needs the user's attention one by one
+        emit signal_sensor_updated(sensor, QString(), false);
+    }
+}
+
+qint64 Domain::memory_estimate() const
+{
+    auto bytes = static_cast<qint64>(sizeof(Domain)) + m_name.capacity() * static_cast<qint64>(sizeof(QChar));
+    // Each Sensor also brings a map node (key, value and tree links) and a
+    // shared pointer control block
+    const auto per_sensor = static_cast<qint64>(sizeof(QString) + sizeof(SensorPtr) + 3 * sizeof(void*) + 2 * sizeof(int));
+    foreach(const SensorPtr& sensor, m_sensors)
+        bytes += sensor->memory_estimate() + per_sensor;
+    return bytes;
+}
@@ -3,20 +3,20 @@
 #include <QMap>
 #include <QObject>
 #include <QString>
-#include <QTimer>
+#include <QStringList>
 #include <QSharedPointer>
 
 #include "Sensor.h"
 
-constexpr int offline_timeout =       10 /* seconds */ * 1000 /* to milliseconds */;
-constexpr int housekeeping_interval = 5                * 1000;
-
 //---------------------------------------------------------------------------
 // Domain
 //
 // A Domain contains one or more Sensors.  In practice, a Domain is a
 // computer system with assets and resources to be monitored.
 //
+// Domains and their Sensors are kept by the Model for consumers that want
+// an object per Sensor; the Model decides when Sensors leave.
+//
 //---------------------------------------------------------------------------
 
 class Domain : public QObject
@@ -31,31 +31,33 @@ public:
     QString     name() const { return m_name; }
 
     bool        has_sensor(const QString& name) const { return m_sensors.contains(name); }
+    SensorPtr   sensor(const QString& name) const { return m_sensors.value(name); }
     void        add_sensor(SensorPtr sensor);
     void        del_sensor(const QString& name);
+    void        del_sensors(const QStringList& names);
     void        update_sensor(QString name, SharedTypes::SensorState state, const QDateTime& update, const QString& message = QString());
+    // Every Sensor goes offline at once; they are removed together later
+    void        set_offline();
 
     int         sensor_count() const { return m_sensors.count(); }
 
+    // Approximate bytes held by this Domain and its Sensors
+    qint64      memory_estimate() const;
+
 signals:
     void        signal_sensor_added(SensorPtr sensor, Domain* domain);
     void        signal_sensor_removed(SensorPtr sensor);
+    void        signal_sensors_removed(const SensorList& sensors);
     void        signal_sensor_updated(SensorPtr sensor, const QString& message, bool notify);
 
-private slots:
-    void        slot_housekeeping();
-
 private:    // typedefs and enums
     using SensorMap = QMap<QString, SensorPtr>;
-    using TimerPtr = QSharedPointer<QTimer>;
 
 private:    // data members
     std::uint64_t   m_id;
     QString     m_name;
 
     SensorMap   m_sensors;
-
-    TimerPtr    m_housekeeping{nullptr};
 };
 
 using DomainPtr = QSharedPointer<Domain>;
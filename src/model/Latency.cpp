@@ -0,0 +1,89 @@
+#include <algorithm>
+
+#include <QFile>
+#include <QDateTime>
+#include <QTextStream>
+
+#include "Latency.h"
+
+void LatencyTracker::record(const LatencyStamp& stamp, qint64 painted, const QString& domain_name)
+{
+    if(!stamp.is_valid())
+        return;
+
+    auto& window = m_windows[stamp.domain_id];
+    if(window.samples[Total].empty())
+    {
+        for(auto& segment : window.samples)
+            segment.assign(window_size, 0);
+    }
+    window.domain_name = domain_name;
+
+    // Clocks on different hosts can disagree; a negative segment is noise
+    auto span = [](qint64 from, qint64 to) { return (from && to) ? qMax(qint64(0), to - from) : qint64(0); };
+
+    auto index = static_cast<size_t>(window.next);
+    window.samples[Total][index] = span(stamp.written, painted);
+    window.samples[Collector][index] = span(stamp.written, stamp.sent);
+    window.samples[Network][index] = span(stamp.sent, stamp.received);
+    window.samples[Display][index] = span(stamp.received, painted);
+
+    window.next = (window.next + 1) % window_size;
+    window.count = qMin(window.count + 1, window_size);
+}
+
+qint64 LatencyTracker::percentile(std::vector<qint64> samples, int count, double p)
+{
+    if(count == 0)
+        return 0;
+
+    samples.resize(static_cast<size_t>(count));
+    auto nth = samples.begin() + static_cast<long>(p * (count - 1));
+    std::nth_element(samples.begin(), nth, samples.end());
+    return *nth;
+}
+
+QList<LatencyTracker::Summary> LatencyTracker::summaries() const
+{
+    QList<Summary> result;
+
+    for(auto iter = m_windows.cbegin();iter != m_windows.cend();++iter)
+    {
+        const auto& window = iter.value();
+
+        Summary summary;
+        summary.domain_id = iter.key();
+        summary.domain_name = window.domain_name;
+        summary.samples = window.count;
+        summary.total_p50 = percentile(window.samples[Total], window.count, 0.50);
+        summary.total_p99 = percentile(window.samples[Total], window.count, 0.99);
+        summary.collector_p50 = percentile(window.samples[Collector], window.count, 0.50);
+        summary.network_p50 = percentile(window.samples[Network], window.count, 0.50);
+        summary.display_p50 = percentile(window.samples[Display], window.count, 0.50);
+        result.append(summary);
+    }
+
+    return result;
+}
+
+bool LatencyTracker::export_csv(const QString& path) const
+{
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+        return false;
+
+    QTextStream out(&file);
+    out << "# Dash'd end-to-end latency, " << QDateTime::currentDateTime().toString(Qt::ISODate) << "\n";
+    out << "domain_id,domain_name,samples,total_p50_ms,total_p99_ms,collector_p50_ms,network_p50_ms,display_p50_ms\n";
+
+    foreach(const auto& summary, summaries())
+    {
+        auto name = summary.domain_name;
+        name.replace('"', "\"\"");
+        out << summary.domain_id << ",\"" << name << "\"," << summary.samples << ","
+            << summary.total_p50 << "," << summary.total_p99 << ","
+            << summary.collector_p50 << "," << summary.network_p50 << "," << summary.display_p50 << "\n";
+    }
+
+    return true;
+}
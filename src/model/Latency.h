@@ -0,0 +1,84 @@
+#pragma once
+
+#include <vector>
+
+#include <QMap>
+#include <QList>
+#include <QString>
+
+//---------------------------------------------------------------------------
+// Latency
+//
+// End-to-end timing of a Sensor state change: the Sensor writes its report
+// ('written', the report's "updated" field), the Collector sends it
+// ("sent"), the Dashboard receives it, and finally paints it.  Timestamps
+// are wall-clock milliseconds from different machines, so segments that
+// cross hosts are only as good as their clock synchronization.
+//---------------------------------------------------------------------------
+
+struct LatencyStamp
+{
+    std::uint64_t domain_id{0};
+    qint64      written{0};
+    qint64      sent{0};
+    qint64      received{0};
+
+    bool        is_valid() const { return received != 0; }
+};
+
+//---------------------------------------------------------------------------
+// LatencyTracker
+//
+// Keeps a rolling window of the most recent samples for each Domain and
+// summarizes them as percentiles.
+//---------------------------------------------------------------------------
+
+class LatencyTracker
+{
+public:     // typedefs and enums
+    // Samples kept per Domain
+    static constexpr int window_size{512};
+
+    struct Summary
+    {
+        std::uint64_t domain_id{0};
+        QString     domain_name;
+        int         samples{0};
+        qint64      total_p50{0};       // written -> painted
+        qint64      total_p99{0};
+        qint64      collector_p50{0};   // written -> sent
+        qint64      network_p50{0};     // sent -> received
+        qint64      display_p50{0};     // received -> painted
+    };
+
+public:
+    LatencyTracker() = default;
+
+    void        record(const LatencyStamp& stamp, qint64 painted, const QString& domain_name);
+    void        forget(std::uint64_t domain_id) { m_windows.remove(domain_id); }
+    void        clear() { m_windows.clear(); }
+
+    QList<Summary> summaries() const;
+
+    // Write the current summaries as CSV
+    bool        export_csv(const QString& path) const;
+
+private:    // typedefs and enums
+    enum Segment { Total, Collector, Network, Display, SegmentCount };
+
+    struct Window
+    {
+        QString     domain_name;
+        std::vector<qint64> samples[SegmentCount];
+        int         next{0};
+        int         count{0};
+    };
+
+    using WindowMap = QMap<std::uint64_t, Window>;
+
+private:    // methods
+    static qint64 percentile(std::vector<qint64> samples, int count, double p);
+
+private:    // data members
+    WindowMap   m_windows;
+};
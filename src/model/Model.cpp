@@ -0,0 +1,437 @@
+#include <cassert>
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+#include <QUrl>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "Model.h"
+#include "Trace.h"
+
+Model::Model(QObject* parent)
+    : QObject{parent}
+{
+    m_expiry.setSingleShot(true);
+    m_expiry.setTimerType(Qt::PreciseTimer);
+    connect(&m_expiry, &QTimer::timeout, this, &Model::slot_expire_offline);
+
+    m_eviction.setInterval(eviction_interval);
+    connect(&m_eviction, &QTimer::timeout, this, &Model::slot_evict_idle);
+    m_eviction.start();
+}
+
+void Model::clear()
+{
+    m_domains.clear();
+    m_table.clear();
+
+    m_offline_deadlines.clear();
+    m_expiry.stop();
+    m_expiry_due = 0;
+}
+
+qint64 Model::memory_estimate() const
+{
+    auto bytes = static_cast<qint64>(sizeof(Model)) + m_table.memory_estimate() + m_offline_deadlines.memory_estimate();
+    foreach(const auto& domain, m_domains)
+        bytes += domain->memory_estimate();
+    return bytes;
+}
+
+bool Model::process_datagram(const QByteArray& datagram)
+{
+    auto doc{QJsonDocument::fromJson(datagram)};
+    if(doc.isNull())
+        return false;
+
+    QJsonObject object = doc.object();
+
+    // Only process events from Collectors
+    if(!object.contains("domain_id") || !object.contains("type"))
+        return false;
+
+    assert(object.contains("domain_name"));
+
+    // A message type from a newer Collector than we understand
+    if(!SharedTypes::MsgText2Type.contains(object["type"].toString()))
+        return false;
+
+    auto msg_type = SharedTypes::MsgText2Type[object["type"].toString()];
+    auto domain_id = static_cast<std::uint64_t>(object["domain_id"].toString().toULongLong());
+    auto domain_name = QUrl::fromPercentEncoding(object["domain_name"].toString().toUtf8());
+
+    // Nothing to take offline in a Domain we never heard from
+    if(msg_type == SharedTypes::MessageType::DomainOffline && !m_table.has_domain(domain_id))
+        return true;
+
+    auto now = QDateTime::currentMSecsSinceEpoch();
+
+    if(!m_table.has_domain(domain_id))
+    {
+        if(m_max_domains && m_table.domain_count() >= m_max_domains)
+            evict_domains();
+
+        m_table.add_domain(domain_id, domain_name);
+
+        if(m_objects)
+        {
+            auto domain = DomainPtr(new Domain(domain_id, domain_name));
+            m_domains[domain->id()] = domain;
+
+            emit signal_domain_added(domain.data());
+        }
+    }
+
+    m_table.touch_domain(domain_id, now);
+
+    // Null unless objects are enabled
+    auto domain = m_domains.value(domain_id);
+
+    switch(msg_type)
+    {
+        case SharedTypes::MessageType::Sensor:
+            assert(object.contains("sensor_name"));
+            assert(object.contains("sensor_state"));
+            assert(object.contains("sensor_message"));
+
+            {
+                auto sensor_name = QUrl::fromPercentEncoding(object["sensor_name"].toString().toUtf8());
+                auto sensor_state = object["sensor_state"].toString().toLower();
+                auto sensor_message = object["sensor_message"].toString();
+                auto state = SharedTypes::MsgText2State[sensor_state];
+
+                auto updated = QDateTime::currentDateTime();
+                if(object.contains("updated"))
+                {
+                    updated = QDateTime::fromMSecsSinceEpoch(object["updated"].toString().toLongLong());
+                    // From the Sensor writing its report to the Dashboard decoding it
+                    TRACE_SPAN_SINCE("sensor_report_in_flight", updated.toMSecsSinceEpoch() * 1000);
+                }
+
+                auto row = m_table.find(domain_id, sensor_name);
+                ++m_reports;
+
+                // Periodic rewrites and rebroadcasts for joining Dashboards
+                // repeat what we have; note that we heard it, and stop here
+                if(row != SensorTable::no_row && m_table.is_repeat(row, state, sensor_message, updated.toMSecsSinceEpoch()))
+                {
+                    m_table.touch(row, now);
+                    ++m_repeats;
+                    break;
+                }
+
+                // Reports can overtake each other (a priority report ahead
+                // of routine ones still queued); never let an older one
+                // undo a newer one
+                if(row != SensorTable::no_row && object.contains("updated") && m_table.is_stale(row, updated.toMSecsSinceEpoch()))
+                {
+                    m_table.touch(row, now);
+                    ++m_stale;
+                    break;
+                }
+
+                if(row == SensorTable::no_row)
+                {
+                    if(m_max_sensors && m_table.sensor_count() >= m_max_sensors)
+                        evict_sensors();
+
+                    auto row = m_table.insert(domain_id, sensor_name, state, sensor_message, updated.toMSecsSinceEpoch(), now);
+                    if(state == SharedTypes::SensorState::Offline)
+                        schedule_expiry(row, now);
+
+                    if(domain)
+                    {
+                        auto sensor = SensorPtr(new Sensor(sensor_name));
+                        sensor->set_state(state, sensor_message);
+                        sensor->set_update(updated);
+                        domain->add_sensor(sensor);
+                    }
+                }
+                else
+                {
+                    if(domain)
+                    {
+                        auto sensor = domain->sensor(sensor_name);
+
+                        // Only a report newer than what we have is a live change
+                        // worth timing; rebroadcasts repeat old news.
+                        if(object.contains("sent") && updated > sensor->last_update())
+                        {
+                            LatencyStamp stamp;
+                            stamp.domain_id = domain_id;
+                            stamp.written = updated.toMSecsSinceEpoch();
+                            stamp.sent = object["sent"].toString().toLongLong();
+                            stamp.received = now;
+                            sensor->set_latency_stamp(stamp);
+                        }
+
+                        domain->update_sensor(sensor_name, state, updated, sensor_message);
+                    }
+
+                    if(m_table.update(row, state, sensor_message, updated.toMSecsSinceEpoch(), now) &&
+                       state == SharedTypes::SensorState::Offline)
+                        schedule_expiry(row, now);
+                }
+
+                emit signal_event(domain_name, sensor_name, sensor_state);
+            }
+            break;
+
+        case SharedTypes::MessageType::Offline:
+            assert(object.contains("sensor_name"));
+            // Sensor has gone offline
+            {
+                auto sensor_name = QUrl::fromPercentEncoding(object["sensor_name"].toString().toUtf8());
+
+                // We may have joined after this Sensor last reported
+                auto row = m_table.find(domain_id, sensor_name);
+                if(row == SensorTable::no_row)
+                    break;
+
+                QString sensor_message;
+                if(object.contains("sensor_message"))
+                    sensor_message = object["sensor_message"].toString();
+
+                // Already offline; a repeat would only restart nothing and log again
+                if(m_table.record(row).state == SharedTypes::SensorState::Offline)
+                {
+                    m_table.touch(row, now);
+                    break;
+                }
+
+                // Keep the Sensor's last report time; ours would make every
+                // report after it look stale
+                if(m_table.update(row, SharedTypes::SensorState::Offline, sensor_message, m_table.record(row).updated, now))
+                    schedule_expiry(row, now);
+                if(domain)
+                    domain->update_sensor(sensor_name, SharedTypes::SensorState::Offline, QDateTime::fromMSecsSinceEpoch(now), sensor_message);
+
+                emit signal_event(domain_name, sensor_name, tr("Offline"));
+            }
+            break;
+
+        case SharedTypes::MessageType::DomainOffline:
+            // The Collector is shutting down, taking all its Sensors with it
+            {
+                auto rows = m_table.set_domain_offline(domain_id, now);
+                // Heard before (from a relay, say); nothing left to take offline
+                if(rows.isEmpty())
+                    break;
+
+                foreach(auto row, rows)
+                    schedule_expiry(row, now);
+                if(domain)
+                    domain->set_offline();
+                emit signal_event(domain_name, QStringLiteral("*"), tr("Offline"));
+            }
+            break;
+
+        case SharedTypes::MessageType::Warning:
+            assert(object.contains("sensor_name"));
+            assert(object.contains("domain_warning"));
+            // A warning of some type
+            {
+                auto sensor_name = QUrl::fromPercentEncoding(object["sensor_name"].toString().toUtf8());
+                auto domain_warning = object["domain_warning"].toString();
+
+                emit signal_event(domain_name, sensor_name, tr("Warning::%1").arg(domain_warning));
+            }
+            break;
+
+        case SharedTypes::MessageType::Error:
+            // An error of some type
+            break;
+    }
+
+    if(m_table.has_changes())
+        schedule_flush();
+
+    arm_expiry(now);
+
+    return true;
+}
+
+void Model::schedule_flush()
+{
+    if(m_flush_scheduled)
+        return;
+
+    m_flush_scheduled = true;
+    QTimer::singleShot(0, this, &Model::slot_flush_changes);
+}
+
+void Model::slot_flush_changes()
+{
+    m_flush_scheduled = false;
+
+    auto changes = m_table.take_changes();
+    if(!changes.isEmpty())
+        emit signal_sensors_changed(changes);
+}
+
+void Model::remove_sensors(const QList<SensorTable::Row>& rows)
+{
+    QMap<std::uint64_t, QStringList> names;
+    foreach(auto row, rows)
+    {
+        if(m_domains.contains(m_table.record(row).domain_id))
+            names[m_table.record(row).domain_id].append(m_table.name(row));
+        m_table.remove(row);
+    }
+
+    // Removed together, so the Dashboard relays out once per Domain
+    for(auto iter = names.cbegin();iter != names.cend();++iter)
+        m_domains[iter.key()]->del_sensors(iter.value());
+
+    if(m_table.has_changes())
+        schedule_flush();
+}
+
+void Model::remove_domain(std::uint64_t id, const QString& reason)
+{
+    if(!m_table.has_domain(id))
+        return;
+
+    ++m_evicted_domains;
+    m_evicted_sensors += m_table.domain_sensor_count(id);
+
+    emit signal_event(m_table.domain_name(id), QStringLiteral("*"), reason);
+
+    m_table.remove_domain(id);
+    // The Domain object takes any Sensors it still has with it as it goes
+    m_domains.remove(id);
+
+    emit signal_domain_removed(id);
+
+    if(m_table.has_changes())
+        schedule_flush();
+}
+
+void Model::evict_domains()
+{
+    // Drop the least recently heard 5% in one pass, so we are not back
+    // here with the very next new Domain.  Ranked rather than cut off at
+    // an age, so Domains heard in the same millisecond do not all go.
+    auto ids = m_table.domain_ids();
+    if(ids.isEmpty())
+        return;
+
+    std::vector<std::pair<qint64, std::uint64_t>> ages;
+    ages.reserve(static_cast<size_t>(ids.count()));
+    foreach(auto id, ids)
+        ages.emplace_back(m_table.domain_heard(id), id);
+
+    auto count = qMax<size_t>(1, ages.size() / 20);
+    std::nth_element(ages.begin(), ages.begin() + static_cast<long>(count - 1), ages.end());
+
+    for(size_t index = 0;index < count;++index)
+        remove_domain(ages[index].second, tr("Evicted (domain limit)"));
+}
+
+void Model::evict_sensors()
+{
+    const auto& records = m_table.records();
+
+    std::vector<std::pair<qint64, SensorTable::Row>> ages;
+    ages.reserve(static_cast<size_t>(m_table.sensor_count()));
+    for(SensorTable::Row row = 0;row < records.size();++row)
+    {
+        if(records[row].live)
+            ages.emplace_back(records[row].heard, row);
+    }
+
+    if(ages.empty())
+        return;
+
+    auto count = qMax<size_t>(1, ages.size() / 20);
+    std::nth_element(ages.begin(), ages.begin() + static_cast<long>(count - 1), ages.end());
+
+    QList<SensorTable::Row> rows;
+    QMap<std::uint64_t, int> counts;
+    for(size_t index = 0;index < count;++index)
+    {
+        auto row = ages[index].second;
+        rows.append(row);
+        ++counts[records[row].domain_id];
+    }
+
+    m_evicted_sensors += rows.count();
+    for(auto iter = counts.cbegin();iter != counts.cend();++iter)
+        emit signal_event(m_table.domain_name(iter.key()), QStringLiteral("*"), tr("Evicted %1 Sensor(s) (sensor limit)").arg(iter.value()));
+
+    remove_sensors(rows);
+}
+
+void Model::schedule_expiry(SensorTable::Row row, qint64 now)
+{
+    m_offline_deadlines.push(now + offline_timeout, row, m_table.record(row).epoch);
+}
+
+void Model::arm_expiry(qint64 now)
+{
+    if(m_offline_deadlines.isEmpty())
+        return;
+
+    // Already set for the soonest deadline (or sooner)
+    auto due = m_offline_deadlines.top().deadline;
+    if(m_expiry.isActive() && m_expiry_due <= due)
+        return;
+
+    m_expiry_due = due;
+    m_expiry.start(static_cast<int>(qMax<qint64>(0, due - now)));
+}
+
+void Model::slot_expire_offline()
+{
+    // Offline Sensors are removed offline_timeout after they went offline,
+    // so the user sees a brief visual cue that a Sensor has gone instead of
+    // relying only on the log.  A Sensor that came back (or was removed)
+    // in the meantime has moved on to a new epoch, and is left alone.
+
+    auto now = QDateTime::currentMSecsSinceEpoch();
+    const auto& records = m_table.records();
+
+    QList<SensorTable::Row> rows;
+    while(!m_offline_deadlines.isEmpty() && m_offline_deadlines.top().deadline <= now)
+    {
+        auto entry = m_offline_deadlines.top();
+        m_offline_deadlines.pop();
+
+        const auto& record = records[entry.row];
+        if(record.live && record.epoch == entry.epoch && record.state == SharedTypes::SensorState::Offline)
+            rows.append(entry.row);
+    }
+
+    // All at once, so a Domain that went offline leaves in one piece
+    if(!rows.isEmpty())
+        remove_sensors(rows);
+
+    arm_expiry(now);
+}
+
+void Model::slot_evict_idle()
+{
+    auto now = QDateTime::currentMSecsSinceEpoch();
+
+    QList<std::uint64_t> empty_ids;
+    QList<std::uint64_t> silent_ids;
+    foreach(auto id, m_table.domain_ids())
+    {
+        auto idle = now - m_table.domain_heard(id);
+
+        // A Domain whose Sensors have all been removed costs memory and
+        // shows nothing; if it speaks again it is simply recreated
+        if(m_table.domain_sensor_count(id) == 0 && idle > offline_timeout)
+            empty_ids.append(id);
+        else if(m_idle_timeout && idle > m_idle_timeout * 1000LL)
+            silent_ids.append(id);
+    }
+
+    foreach(auto id, empty_ids)
+        remove_domain(id, tr("Removed (empty)"));
+    foreach(auto id, silent_ids)
+        remove_domain(id, tr("Evicted (silent)"));
+}
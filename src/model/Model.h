@@ -0,0 +1,147 @@
+#pragma once
+
+#include <QMap>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QByteArray>
+#include <QSharedPointer>
+
+#include "Domain.h"
+#include "SensorTable.h"
+#include "DeadlineHeap.h"
+
+// How long an offline Sensor stays on display before it is removed
+constexpr int offline_timeout =       10 /* seconds */ * 1000 /* to milliseconds */;
+// How often idle Domains are looked for
+constexpr int eviction_interval =     30               * 1000;
+
+//---------------------------------------------------------------------------
+// Model
+//
+// The Dashboard's view of the ring, without the Dashboard: decodes the
+// datagrams Collectors send and applies them to the Domains and Sensors
+// they describe.  Nothing here depends on a display, so the model can be
+// driven by a Dashboard, a benchmark, or a replay tool alike.
+//
+// Sensors are kept in a flat SensorTable, and changes to it are announced
+// once per pass of the event loop with 'signal_sensors_changed'.  For
+// consumers that want an object per Sensor (the Dashboard), the model can
+// also keep a Domain and Sensor QObject for each, emitting their signals
+// as before; switch that off with 'set_objects_enabled' before use.
+//---------------------------------------------------------------------------
+
+class Model : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit Model(QObject* parent = nullptr);
+
+    // Decode one datagram from the ring and apply it.  Returns false if the
+    // datagram was not a Collector report we understand.
+    bool        process_datagram(const QByteArray& datagram);
+
+    // Keep Domain and Sensor objects alongside the table (the default)
+    void        set_objects_enabled(bool enabled) { m_objects = enabled; }
+    bool        objects_enabled() const { return m_objects; }
+
+    const SensorTable& table() const { return m_table; }
+
+    bool        has_domain(std::uint64_t id) const { return m_table.has_domain(id); }
+    QString     domain_name(std::uint64_t id) const { return m_table.domain_name(id); }
+    // The Domain's object; null if objects are not enabled
+    DomainPtr   domain(std::uint64_t id) const { return m_domains.value(id); }
+    int         domain_count() const { return m_table.domain_count(); }
+    int         sensor_count() const { return m_table.sensor_count(); }
+
+    void        clear();
+
+    // Forget Domains not heard from in 'seconds' (0 keeps them until they
+    // go offline).  Empty Domains are always forgotten once quiet.
+    void        set_idle_timeout(int seconds) { m_idle_timeout = qMax(0, seconds); }
+    // Hard caps on what is tracked (0 for no limit); the least recently
+    // heard Domains or Sensors make room for new ones
+    void        set_max_domains(int max) { m_max_domains = qMax(0, max); }
+    void        set_max_sensors(int max) { m_max_sensors = qMax(0, max); }
+
+    // Sensor reports that repeated what we already had, and were dropped
+    // before reaching the Domains and the log, out of all Sensor reports
+    quint64     repeats_dropped() const { return m_repeats; }
+    quint64     reports_checked() const { return m_reports; }
+    // Sensor reports older than what we already had, and dropped
+    quint64     stale_dropped() const { return m_stale; }
+
+    int         evicted_domains() const { return m_evicted_domains; }
+    int         evicted_sensors() const { return m_evicted_sensors; }
+
+    // Approximate bytes held by every Domain and Sensor tracked
+    qint64      memory_estimate() const;
+
+public slots:
+    // Announce the table's pending changes now rather than on the next pass
+    // of the event loop (for callers without one)
+    void        slot_flush_changes();
+
+signals:
+    // A Domain was heard from for the first time; connect to its Sensor signals here
+    void        signal_domain_added(Domain* domain);
+    // A Domain was forgotten, along with any Sensors it still had
+    void        signal_domain_removed(std::uint64_t id);
+    // Rows of table() added, updated or removed since the last time.  Removed
+    // rows can still be read during the signal, but not after; connect
+    // directly.
+    void        signal_sensors_changed(const SensorTable::ChangeList& changes);
+    // A human-readable account of what a datagram did, for the log
+    void        signal_event(const QString& domain_name, const QString& sensor_name, const QString& detail);
+
+private slots:
+    void        slot_expire_offline();
+    void        slot_evict_idle();
+
+private:    // typedefs and enums
+    using DomainMap = QMap<std::uint64_t, DomainPtr>;
+
+private:    // methods
+    void        schedule_flush();
+    // Remove 'row' offline_timeout from now, unless its state changes first
+    void        schedule_expiry(SensorTable::Row row, qint64 now);
+    void        arm_expiry(qint64 now);
+
+    // Removes Sensors from the table and from their Domain objects, one
+    // batch per Domain
+    void        remove_sensors(const QList<SensorTable::Row>& rows);
+    void        remove_domain(std::uint64_t id, const QString& reason);
+    // Make room under the caps by dropping the least recently heard 5%
+    void        evict_domains();
+    void        evict_sensors();
+
+private:    // data members
+    SensorTable m_table;
+    bool        m_flush_scheduled{false};
+
+    // Domain objects, when enabled
+    bool        m_objects{true};
+    DomainMap   m_domains;
+
+    // When each offline Sensor is due to be removed, soonest first, and
+    // one timer set for the soonest
+    DeadlineHeap m_offline_deadlines;
+    QTimer      m_expiry;
+    qint64      m_expiry_due{0};
+
+    int         m_idle_timeout{60 * 60};
+    int         m_max_domains{1000};
+    int         m_max_sensors{25000};
+
+    int         m_evicted_domains{0};
+    int         m_evicted_sensors{0};
+
+    quint64     m_repeats{0};
+    quint64     m_stale{0};
+    quint64     m_reports{0};
+
+    QTimer      m_eviction;
+};
+
+using ModelPtr = QSharedPointer<Model>;
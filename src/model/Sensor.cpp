@@ -0,0 +1,60 @@
+#include "Sensor.h"
+
+const QMap<SharedTypes::SensorState, QString> Sensor::StateImages{
+    {SharedTypes::SensorState::Healthy, QStringLiteral(":/images/Healthy.png")},
+    {SharedTypes::SensorState::Poor, QStringLiteral(":/images/Poor.png")},
+    {SharedTypes::SensorState::Critical, QStringLiteral(":/images/Critical.png")},
+    {SharedTypes::SensorState::Deceased, QStringLiteral(":/images/Deceased.png")},
+    {SharedTypes::SensorState::Offline, QStringLiteral(":/images/Offline.png")},
+};
+
+Sensor::Sensor(const QString& name, QObject* parent)
+    : QObject{parent},
+      m_name(name)
+{
+}
+
+void Sensor::set_state(SharedTypes::SensorState state, const QString& message)
+{
+    assert(state != SharedTypes::SensorState::Undefined);
+
+    m_message = message;
+
+    if(state != m_state)
+    {
+        m_state = state;
+        emit signal_state_changed();
+    }
+}
+
+void Sensor::set_update(const QDateTime& stamp)
+{
+    m_last_update = stamp;
+
+    auto last = (m_history_next + history_size - 1) % history_size;
+    if(m_history_count && m_history[last].state == m_state)
+        return;
+
+    m_history[m_history_next] = Sample{stamp.toMSecsSinceEpoch(), m_state};
+    m_history_next = (m_history_next + 1) % history_size;
+    m_history_count = qMin(m_history_count + 1, history_size);
+    ++m_history_revision;
+}
+
+QVector<Sensor::Sample> Sensor::history() const
+{
+    QVector<Sample> samples;
+    samples.reserve(m_history_count);
+
+    auto first = (m_history_next + history_size - m_history_count) % history_size;
+    for(int i = 0;i < m_history_count;++i)
+        samples.append(m_history[(first + i) % history_size]);
+
+    return samples;
+}
+
+qint64 Sensor::memory_estimate() const
+{
+    return static_cast<qint64>(sizeof(Sensor)) +
+           (m_name.capacity() + m_message.capacity()) * static_cast<qint64>(sizeof(QChar));
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <QObject>
+
+#include <array>
+
+#include <QMap>
+#include <QList>
+#include <QVector>
+#include <QDateTime>
+#include <QSharedPointer>
+
+#include "SharedTypes.h"
+#include "Latency.h"
+
+//---------------------------------------------------------------------------
+// Sensor
+//
+// A Sensor is concered with the state of an asset or resource.  In practice,
+// a Sensor is a program of some type running on a computer system, reporting
+// the state of an asset or resource when something interesting happens.
+//
+//---------------------------------------------------------------------------
+
+class Sensor : public QObject
+{
+    Q_OBJECT
+
+public:    // typedefs and enums
+    struct Sample
+    {
+        qint64      when{0};    // milliseconds since the epoch
+        SharedTypes::SensorState state{SharedTypes::SensorState::Undefined};
+    };
+
+    // State changes remembered for each Sensor
+    static constexpr int history_size{32};
+
+public:    // data members
+    const static QMap<SharedTypes::SensorState, QString> StateImages;
+
+public:
+    explicit Sensor(const QString& name, QObject* parent = nullptr);
+
+    const QString&  name() const { return m_name; }
+
+    SharedTypes::SensorState     state() const { return m_state; }
+    const QString&  message() const { return m_message; }
+    QDateTime       last_update() const { return m_last_update; }
+
+    // Approximate bytes held by this Sensor, for the memory readout
+    qint64          memory_estimate() const;
+
+    void            set_state(SharedTypes::SensorState state, const QString& message = QString());
+    // Also records a history sample if the state has changed since the last
+    void            set_update(const QDateTime& stamp);
+
+    // Recent state changes, oldest first; 'history_revision' changes
+    // whenever a sample is added
+    QVector<Sample> history() const;
+    quint32         history_revision() const { return m_history_revision; }
+
+    // Timing of the live update most recently applied, until it is painted
+    void            set_latency_stamp(const LatencyStamp& stamp) { m_latency_stamp = stamp; }
+    LatencyStamp    take_latency_stamp() { auto stamp = m_latency_stamp; m_latency_stamp = LatencyStamp(); return stamp; }
+
+signals:
+    void            signal_state_changed();
+    void            signal_removed();
+
+private:    // typedefs and enums
+
+private:    // data members
+    QString         m_name;
+    SharedTypes::SensorState     m_state{SharedTypes::SensorState::Undefined};
+    QString         m_message;
+
+    QDateTime       m_last_update;
+
+    LatencyStamp    m_latency_stamp;
+
+    // A ring of the most recent samples, so a Sensor's memory stays fixed
+    std::array<Sample, history_size> m_history;
+    int             m_history_next{0};
+    int             m_history_count{0};
+    quint32         m_history_revision{0};
+};
+
+using SensorPtr = QSharedPointer<Sensor>;
+using SensorList = QList<SensorPtr>;
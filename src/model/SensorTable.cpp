@@ -0,0 +1,259 @@
+#include <cassert>
+#include <algorithm>
+
+#include "SensorTable.h"
+
+void SensorTable::add_domain(std::uint64_t domain_id, const QString& name)
+{
+    if(m_domains.contains(domain_id))
+        return;
+
+    DomainRecord domain;
+    domain.name = m_strings.intern(name);
+    m_domains.insert(domain_id, domain);
+}
+
+void SensorTable::remove_domain(std::uint64_t domain_id)
+{
+    auto iter = m_domains.find(domain_id);
+    if(iter == m_domains.end())
+        return;
+
+    // Taken first, so 'remove' has nothing to search through
+    auto rows = std::move(iter.value().rows);
+    iter.value().rows.clear();
+    for(auto row : rows)
+        remove(row);
+
+    m_strings.release(m_domains[domain_id].name);
+    m_domains.remove(domain_id);
+}
+
+void SensorTable::touch_domain(std::uint64_t domain_id, qint64 heard)
+{
+    auto iter = m_domains.find(domain_id);
+    if(iter != m_domains.end())
+        iter.value().heard = heard;
+}
+
+QList<SensorTable::Row> SensorTable::set_domain_offline(std::uint64_t domain_id, qint64 when)
+{
+    QList<Row> rows;
+
+    auto iter = m_domains.constFind(domain_id);
+    if(iter == m_domains.constEnd())
+        return rows;
+
+    for(auto row : iter.value().rows)
+    {
+        auto& record = m_records[row];
+        if(record.state == SharedTypes::SensorState::Offline)
+            continue;
+
+        // 'updated' stays the Sensor's own last report time
+        record.state = SharedTypes::SensorState::Offline;
+        record.heard = when;
+        ++record.epoch;
+        mark(row, Change::Updated);
+        rows.append(row);
+    }
+
+    return rows;
+}
+
+QString SensorTable::domain_name(std::uint64_t domain_id) const
+{
+    auto iter = m_domains.constFind(domain_id);
+    return iter == m_domains.constEnd() ? QString() : m_strings.string(iter.value().name);
+}
+
+qint64 SensorTable::domain_heard(std::uint64_t domain_id) const
+{
+    auto iter = m_domains.constFind(domain_id);
+    return iter == m_domains.constEnd() ? 0 : iter.value().heard;
+}
+
+int SensorTable::domain_sensor_count(std::uint64_t domain_id) const
+{
+    auto iter = m_domains.constFind(domain_id);
+    return iter == m_domains.constEnd() ? 0 : static_cast<int>(iter.value().rows.size());
+}
+
+SensorTable::Row SensorTable::find(std::uint64_t domain_id, const QString& name) const
+{
+    auto name_id = m_strings.find(name);
+    if(name_id == 0)
+        return no_row;
+
+    return m_index.value(SensorKey{domain_id, name_id}, no_row);
+}
+
+SensorTable::Row SensorTable::insert(std::uint64_t domain_id, const QString& name, SharedTypes::SensorState state,
+                                     const QString& message, qint64 updated, qint64 heard)
+{
+    assert(m_domains.contains(domain_id));
+    assert(find(domain_id, name) == no_row);
+
+    Row row;
+    if(!m_free.empty())
+    {
+        row = m_free.back();
+        m_free.pop_back();
+    }
+    else
+    {
+        row = static_cast<Row>(m_records.size());
+        m_records.emplace_back();
+    }
+
+    auto& record = m_records[row];
+    record.domain_id = domain_id;
+    record.name = m_strings.intern(name);
+    record.message = m_strings.intern(message);
+    record.updated = updated;
+    record.heard = heard;
+    record.state = state;
+    ++record.epoch;
+    record.pending = Change::None;
+    record.live = true;
+
+    m_index.insert(SensorKey{domain_id, record.name}, row);
+    m_domains[domain_id].rows.push_back(row);
+    ++m_live;
+
+    mark(row, Change::Added);
+    return row;
+}
+
+bool SensorTable::is_repeat(Row row, SharedTypes::SensorState state, const QString& message, qint64 updated) const
+{
+    const auto& record = m_records[row];
+    // An interned message is the same message exactly when it has the same id
+    return record.state == state && record.updated == updated && record.message == m_strings.find(message);
+}
+
+bool SensorTable::update(Row row, SharedTypes::SensorState state, const QString& message, qint64 updated, qint64 heard)
+{
+    auto& record = m_records[row];
+    assert(record.live);
+
+    record.heard = heard;
+
+    // Rebroadcasts repeat what we already have; only the time heard moves
+    if(is_repeat(row, state, message, updated))
+        return false;
+
+    if(m_strings.string(record.message) != message)
+    {
+        m_strings.release(record.message);
+        record.message = m_strings.intern(message);
+    }
+
+    auto changed = record.state != state;
+    if(changed)
+    {
+        record.state = state;
+        ++record.epoch;
+    }
+
+    record.updated = updated;
+    mark(row, Change::Updated);
+    return changed;
+}
+
+void SensorTable::remove(Row row)
+{
+    auto& record = m_records[row];
+    if(!record.live)
+        return;
+
+    unindex(row);
+    record.live = false;
+    --m_live;
+
+    // The contents stay until the removal has been taken
+    mark(row, Change::Removed);
+    m_retired.push_back(row);
+}
+
+void SensorTable::unindex(Row row)
+{
+    const auto& record = m_records[row];
+    m_index.remove(SensorKey{record.domain_id, record.name});
+
+    auto iter = m_domains.find(record.domain_id);
+    if(iter != m_domains.end())
+    {
+        auto& rows = iter.value().rows;
+        rows.erase(std::remove(rows.begin(), rows.end(), row), rows.end());
+    }
+}
+
+void SensorTable::mark(Row row, Change change)
+{
+    auto& record = m_records[row];
+    if(record.pending == Change::None)
+    {
+        m_changed.push_back(row);
+        record.pending = change;
+    }
+    // An add is still an add however often it is updated; anything removed
+    // is simply removed
+    else if(change == Change::Removed)
+        record.pending = record.pending == Change::Added ? Change::None : Change::Removed;
+}
+
+SensorTable::ChangeList SensorTable::take_changes()
+{
+    ChangeList changes;
+    changes.reserve(static_cast<int>(m_changed.size()));
+    for(auto row : m_changed)
+    {
+        auto& record = m_records[row];
+        if(record.pending != Change::None)
+            changes.append(ChangeEntry{row, record.pending});
+        record.pending = Change::None;
+    }
+    m_changed.clear();
+
+    // Nobody can ask about these rows any more
+    for(auto row : m_retired)
+    {
+        auto& record = m_records[row];
+        m_strings.release(record.name);
+        m_strings.release(record.message);
+        // Anything still scheduled against this row must not match its next tenant
+        auto epoch = record.epoch;
+        record = Record();
+        record.epoch = epoch + 1;
+        m_free.push_back(row);
+    }
+    m_retired.clear();
+
+    return changes;
+}
+
+qint64 SensorTable::memory_estimate() const
+{
+    auto bytes = static_cast<qint64>(sizeof(SensorTable));
+    bytes += static_cast<qint64>(m_records.capacity() * sizeof(Record));
+    bytes += static_cast<qint64>((m_free.capacity() + m_retired.capacity() + m_changed.capacity()) * sizeof(Row));
+    // Hash nodes: key, value and a couple of pointers each
+    bytes += m_index.count() * static_cast<qint64>(sizeof(SensorKey) + sizeof(Row) + 2 * sizeof(void*));
+    foreach(const auto& domain, m_domains)
+        bytes += static_cast<qint64>(sizeof(DomainRecord) + sizeof(std::uint64_t) + 2 * sizeof(void*) + domain.rows.capacity() * sizeof(Row));
+    bytes += m_strings.memory_estimate();
+    return bytes;
+}
+
+void SensorTable::clear()
+{
+    m_records.clear();
+    m_free.clear();
+    m_retired.clear();
+    m_changed.clear();
+    m_live = 0;
+    m_index.clear();
+    m_domains.clear();
+    m_strings.clear();
+}
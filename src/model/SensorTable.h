@@ -0,0 +1,151 @@
+#pragma once
+
+#include <vector>
+
+#include <QHash>
+#include <QList>
+#include <QVector>
+#include <QString>
+
+#include "SharedTypes.h"
+#include "StringPool.h"
+
+//---------------------------------------------------------------------------
+// SensorTable
+//
+// Every Sensor the model tracks, as plain records in one flat array, with
+// Domain and Sensor names and messages interned.  A Sensor is addressed by
+// its row, which stays the same for as long as the Sensor is tracked.
+//
+// Changes are not announced one by one: the table remembers which rows were
+// added, updated or removed since changes were last taken, once per row, so
+// a consumer catches up on a whole burst of reports in one pass.  A removed
+// row keeps its contents until the change that reports it has been taken.
+//---------------------------------------------------------------------------
+
+class SensorTable
+{
+public:     // typedefs and enums
+    using Row = quint32;
+    static constexpr Row no_row{0xFFFFFFFFu};
+
+    enum class Change : quint8
+    {
+        None,
+        Added,
+        Updated,
+        Removed
+    };
+
+    struct Record
+    {
+        std::uint64_t domain_id{0};
+        quint32     name{0};        // interned
+        quint32     message{0};     // interned
+        qint64      updated{0};     // the Sensor's last report time (ms since the epoch, the Collector's
+                                    // clock); kept as is when it goes offline
+        qint64      heard{0};       // when we last heard of it, by our clock
+        SharedTypes::SensorState state{SharedTypes::SensorState::Undefined};
+        // Moves on whenever the state changes or the row is reused
+        quint32     epoch{0};
+        Change      pending{Change::None};
+        bool        live{false};
+    };
+
+    struct ChangeEntry
+    {
+        Row         row{no_row};
+        Change      change{Change::None};
+    };
+    using ChangeList = QVector<ChangeEntry>;
+
+public:
+    SensorTable() = default;
+
+    // Domains
+    bool        has_domain(std::uint64_t domain_id) const { return m_domains.contains(domain_id); }
+    void        add_domain(std::uint64_t domain_id, const QString& name);
+    // Removes the Domain and every Sensor in it
+    void        remove_domain(std::uint64_t domain_id);
+    void        touch_domain(std::uint64_t domain_id, qint64 heard);
+    // Every Sensor in the Domain goes Offline as of 'when'; returns the rows
+    // that were not Offline already
+    QList<Row>  set_domain_offline(std::uint64_t domain_id, qint64 when);
+
+    int         domain_count() const { return m_domains.count(); }
+    QList<std::uint64_t> domain_ids() const { return m_domains.keys(); }
+    QString     domain_name(std::uint64_t domain_id) const;
+    qint64      domain_heard(std::uint64_t domain_id) const;
+    int         domain_sensor_count(std::uint64_t domain_id) const;
+
+    // Sensors
+    Row         find(std::uint64_t domain_id, const QString& name) const;
+    Row         insert(std::uint64_t domain_id, const QString& name, SharedTypes::SensorState state,
+                       const QString& message, qint64 updated, qint64 heard);
+    // True if the report would change nothing but the time heard
+    bool        is_repeat(Row row, SharedTypes::SensorState state, const QString& message, qint64 updated) const;
+    // True if the report was written before the one we already have.  An
+    // offline Sensor takes whatever comes next: a restarted Collector
+    // resends reports as old as its files.
+    bool        is_stale(Row row, qint64 updated) const
+    {
+        return m_records[row].state != SharedTypes::SensorState::Offline && updated < m_records[row].updated;
+    }
+    void        touch(Row row, qint64 heard) { m_records[row].heard = heard; }
+    // Returns true if the state changed
+    bool        update(Row row, SharedTypes::SensorState state, const QString& message, qint64 updated, qint64 heard);
+    void        remove(Row row);
+
+    int         sensor_count() const { return m_live; }
+
+    // All rows, live or not; skip those that are not 'live'
+    const std::vector<Record>& records() const { return m_records; }
+    const Record& record(Row row) const { return m_records[row]; }
+    const QString& name(Row row) const { return m_strings.string(m_records[row].name); }
+    const QString& message(Row row) const { return m_strings.string(m_records[row].message); }
+
+    // Rows changed since the last call, each once.  Rows removed before
+    // this call are reused after it.
+    ChangeList  take_changes();
+    bool        has_changes() const { return !m_changed.empty(); }
+
+    qint64      memory_estimate() const;
+
+    void        clear();
+
+private:    // typedefs and enums
+    struct DomainRecord
+    {
+        quint32     name{0};
+        qint64      heard{0};
+        std::vector<Row> rows;
+    };
+
+    struct SensorKey
+    {
+        std::uint64_t domain_id;
+        quint32     name;
+
+        bool operator==(const SensorKey& other) const { return domain_id == other.domain_id && name == other.name; }
+    };
+    friend uint qHash(const SensorKey& key, uint seed) { return qHash(key.domain_id, seed) ^ key.name; }
+
+private:    // methods
+    void        mark(Row row, Change change);
+    void        unindex(Row row);
+
+private:    // data members
+    std::vector<Record> m_records;
+    // Removed rows that may be reused
+    std::vector<Row>    m_free;
+    // Removed rows waiting for their change to be taken
+    std::vector<Row>    m_retired;
+    std::vector<Row>    m_changed;
+
+    int         m_live{0};
+
+    QHash<SensorKey, Row>   m_index;
+    QHash<std::uint64_t, DomainRecord> m_domains;
+
+    StringPool  m_strings;
+};
@@ -0,0 +1,74 @@
+#include <cassert>
+
+#include "StringPool.h"
+
+StringPool::StringPool()
+{
+    clear();
+}
+
+quint32 StringPool::intern(const QString& str)
+{
+    if(str.isEmpty())
+        return 0;
+
+    auto iter = m_ids.constFind(str);
+    if(iter != m_ids.constEnd())
+    {
+        ++m_entries[iter.value()].references;
+        return iter.value();
+    }
+
+    quint32 id;
+    if(!m_free.empty())
+    {
+        id = m_free.back();
+        m_free.pop_back();
+    }
+    else
+    {
+        id = static_cast<quint32>(m_entries.size());
+        m_entries.emplace_back();
+    }
+
+    m_entries[id].str = str;
+    m_entries[id].references = 1;
+    m_ids.insert(str, id);
+    return id;
+}
+
+void StringPool::release(quint32 id)
+{
+    if(id == 0)
+        return;
+
+    auto& entry = m_entries[id];
+    assert(entry.references > 0);
+    if(--entry.references)
+        return;
+
+    m_ids.remove(entry.str);
+    entry.str = QString();
+    m_free.push_back(id);
+}
+
+qint64 StringPool::memory_estimate() const
+{
+    // Each string is held once by its entry and shared (implicitly) with
+    // the hash key; the hash node costs a few pointers more
+    auto bytes = static_cast<qint64>(m_entries.capacity() * sizeof(Entry) + m_free.capacity() * sizeof(quint32));
+    for(const auto& entry : m_entries)
+        bytes += entry.str.capacity() * static_cast<qint64>(sizeof(QChar));
+    bytes += m_ids.count() * static_cast<qint64>(sizeof(QString) + sizeof(quint32) + 2 * sizeof(void*));
+    return bytes;
+}
+
+void StringPool::clear()
+{
+    m_entries.clear();
+    m_free.clear();
+    m_ids.clear();
+
+    // Id 0, the empty string, is never released
+    m_entries.emplace_back();
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+
+#include <QHash>
+#include <QString>
+
+//---------------------------------------------------------------------------
+// StringPool
+//
+// Interns strings so that each distinct one is stored once and referred to
+// by a small id.  Ids are reference counted; a string is dropped when its
+// last reference is released, and its id reused.  Id 0 is always the empty
+// string.
+//---------------------------------------------------------------------------
+
+class StringPool
+{
+public:
+    StringPool();
+
+    // Adds a reference to 'str', storing it if it is new
+    quint32     intern(const QString& str);
+    // Adds a reference to an id already held
+    void        retain(quint32 id) { if(id) ++m_entries[id].references; }
+    void        release(quint32 id);
+
+    // The id 'str' already has, or 0
+    quint32     find(const QString& str) const { return m_ids.value(str, 0); }
+
+    const QString& string(quint32 id) const { return m_entries[id].str; }
+
+    int         count() const { return m_ids.count(); }
+    qint64      memory_estimate() const;
+
+    void        clear();
+
+private:    // typedefs and enums
+    struct Entry
+    {
+        QString     str;
+        quint32     references{0};
+    };
+
+private:    // data members
+    std::vector<Entry>      m_entries;
+    std::vector<quint32>    m_free;
+    QHash<QString, quint32> m_ids;
+};
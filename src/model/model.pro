@@ -0,0 +1,48 @@
+QT = core
+
+TEMPLATE = lib
+CONFIG += c++17 staticlib
+TARGET = dashd-model
+
+# You can make your code fail to compile if it uses deprecated APIs.
+# In order to do so, uncomment the following line.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+mac {
+    DEFINES += QT_OSX
+}
+
+unix:!mac {
+    DEFINES += QT_LINUX
+}
+
+win32 {
+    DEFINES += QT_WIN
+}
+
+# Trace spans (see common/Trace.h) are compiled in with: qmake "DEFINES+=DASHD_TRACE"
+# (the Dashboard gets Trace.cpp from this library)
+
+INCLUDEPATH += ../common
+
+SOURCES += \
+    ../common/SharedTypes.cpp \
+    ../common/Trace.cpp \
+    DeadlineHeap.cpp \
+    Domain.cpp \
+    Latency.cpp \
+    Model.cpp \
+    Sensor.cpp \
+    SensorTable.cpp \
+    StringPool.cpp
+
+HEADERS += \
+    ../common/SharedTypes.h \
+    ../common/Trace.h \
+    DeadlineHeap.h \
+    Domain.h \
+    Latency.h \
+    Model.h \
+    Sensor.h \
+    SensorTable.h \
+    StringPool.h
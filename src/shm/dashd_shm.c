@@ -0,0 +1,315 @@
+/* shm_open, ftruncate and pread are POSIX; ask for them under -std=c11 */
+#define _POSIX_C_SOURCE 200809L
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dashd_shm.h"
+
+/* How many times a reader retries a slot that keeps changing underneath it */
+#define DASHD_SHM_READ_RETRIES 16
+/* How long (in yields) we wait for another process to finish claiming a slot */
+#define DASHD_SHM_CLAIM_WAITS 1000
+
+/* Values of 'in_use' */
+#define DASHD_SHM_FREE          0u
+#define DASHD_SHM_CLAIMING      1u
+#define DASHD_SHM_CLAIMED       2u
+
+struct dashd_shm
+{
+    int                         fd;
+    size_t                      size;
+    struct dashd_shm_header*    header;
+    struct dashd_shm_slot*      slots;
+};
+
+_Static_assert(sizeof(struct dashd_shm_slot) == DASHD_SHM_SLOT_SIZE, "slot layout must be fixed");
+
+static size_t segment_size(uint32_t slot_count)
+{
+    return sizeof(struct dashd_shm_header) + (size_t)slot_count * DASHD_SHM_SLOT_SIZE;
+}
+
+static dashd_shm_t* map_segment(int fd, size_t size)
+{
+    dashd_shm_t* shm;
+    void* base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(base == MAP_FAILED)
+        return NULL;
+
+    shm = (dashd_shm_t*)calloc(1, sizeof(dashd_shm_t));
+    if(!shm)
+    {
+        munmap(base, size);
+        return NULL;
+    }
+
+    shm->fd = fd;
+    shm->size = size;
+    shm->header = (struct dashd_shm_header*)base;
+    shm->slots = (struct dashd_shm_slot*)((char*)base + sizeof(struct dashd_shm_header));
+    return shm;
+}
+
+static int64_t now_msecs(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+dashd_shm_t* dashd_shm_create(const char* name, uint32_t slot_count)
+{
+    dashd_shm_t* shm;
+    size_t size;
+    int fd;
+
+    if(slot_count == 0 || slot_count > DASHD_SHM_MAX_SLOTS)
+        return NULL;
+
+    size = segment_size(slot_count);
+
+    /* Start from a clean segment; slots from a previous run are stale */
+    shm_unlink(name);
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0660);
+    if(fd < 0)
+        return NULL;
+
+    if(ftruncate(fd, (off_t)size) < 0)
+    {
+        close(fd);
+        shm_unlink(name);
+        return NULL;
+    }
+
+    shm = map_segment(fd, size);
+    if(!shm)
+    {
+        close(fd);
+        shm_unlink(name);
+        return NULL;
+    }
+
+    shm->header->version = DASHD_SHM_VERSION;
+    shm->header->slot_count = slot_count;
+    shm->header->slot_size = DASHD_SHM_SLOT_SIZE;
+    /* Publish the magic last so a Sensor never sees a half-built header */
+    __atomic_store_n(&shm->header->magic, DASHD_SHM_MAGIC, __ATOMIC_RELEASE);
+
+    return shm;
+}
+
+dashd_shm_t* dashd_shm_open(const char* name)
+{
+    struct dashd_shm_header header;
+    dashd_shm_t* shm;
+    int fd;
+
+    fd = shm_open(name, O_RDWR, 0);
+    if(fd < 0)
+        return NULL;
+
+    if(pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+       header.magic != DASHD_SHM_MAGIC ||
+       header.version != DASHD_SHM_VERSION ||
+       header.slot_size != DASHD_SHM_SLOT_SIZE ||
+       header.slot_count == 0 || header.slot_count > DASHD_SHM_MAX_SLOTS)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    shm = map_segment(fd, segment_size(header.slot_count));
+    if(!shm)
+        close(fd);
+
+    return shm;
+}
+
+void dashd_shm_close(dashd_shm_t* shm)
+{
+    if(!shm)
+        return;
+
+    munmap(shm->header, shm->size);
+    close(shm->fd);
+    free(shm);
+}
+
+int dashd_shm_unlink(const char* name)
+{
+    return shm_unlink(name);
+}
+
+uint32_t dashd_shm_slot_count(const dashd_shm_t* shm)
+{
+    return shm->header->slot_count;
+}
+
+void dashd_shm_mark_dirty(dashd_shm_t* shm, uint32_t slot)
+{
+    __atomic_fetch_or(&shm->header->dirty[slot / 64u], (uint64_t)1 << (slot % 64u), __ATOMIC_RELEASE);
+}
+
+uint64_t dashd_shm_take_dirty(dashd_shm_t* shm, uint32_t word)
+{
+    return __atomic_exchange_n(&shm->header->dirty[word], 0, __ATOMIC_ACQUIRE);
+}
+
+static void write_slot(dashd_shm_t* shm, uint32_t index, enum dashd_state state, const char* message)
+{
+    struct dashd_shm_slot* slot = &shm->slots[index];
+    uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED);
+    size_t length = message ? strlen(message) : 0;
+
+    if(length >= DASHD_SHM_MESSAGE_SIZE)
+        length = DASHD_SHM_MESSAGE_SIZE - 1;
+
+    __atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    slot->updated = now_msecs();
+    slot->state = (uint32_t)state;
+    slot->message_length = (uint32_t)length;
+    if(length)
+        memcpy(slot->message, message, length);
+    slot->message[length] = '\0';
+
+    __atomic_store_n(&slot->seq, seq + 2, __ATOMIC_RELEASE);
+
+    dashd_shm_mark_dirty(shm, index);
+}
+
+static int claimed_as(const struct dashd_shm_slot* slot, const char* sensor_name)
+{
+    uint32_t in_use = __atomic_load_n(&slot->in_use, __ATOMIC_ACQUIRE);
+    int waits;
+
+    /* A claim in progress is a few stores from done; wait it out (but not
+       forever, in case its process died in the middle) */
+    for(waits = 0;in_use == DASHD_SHM_CLAIMING && waits < DASHD_SHM_CLAIM_WAITS;++waits)
+    {
+        sched_yield();
+        in_use = __atomic_load_n(&slot->in_use, __ATOMIC_ACQUIRE);
+    }
+
+    return in_use == DASHD_SHM_CLAIMED && !strncmp(slot->name, sensor_name, DASHD_SHM_NAME_SIZE);
+}
+
+int dashd_shm_claim(dashd_shm_t* shm, const char* sensor_name)
+{
+    uint32_t count = shm->header->slot_count;
+    uint32_t i, j;
+
+    if(!sensor_name || !*sensor_name || strlen(sensor_name) >= DASHD_SHM_NAME_SIZE)
+        return -1;
+
+    /* A restarted Sensor gets its old slot back */
+    for(i = 0;i < count;++i)
+    {
+        if(claimed_as(&shm->slots[i], sensor_name))
+            return (int)i;
+    }
+
+    for(i = 0;i < count;++i)
+    {
+        uint32_t expected = DASHD_SHM_FREE;
+        if(__atomic_compare_exchange_n(&shm->slots[i].in_use, &expected, DASHD_SHM_CLAIMING, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+        {
+            struct dashd_shm_slot* slot = &shm->slots[i];
+            uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED);
+
+            __atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELAXED);
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+            memset(slot->name, 0, DASHD_SHM_NAME_SIZE);
+            strcpy(slot->name, sensor_name);
+            slot->state = DASHD_STATE_UNDEFINED;
+            slot->message_length = 0;
+            slot->message[0] = '\0';
+            __atomic_store_n(&slot->seq, seq + 2, __ATOMIC_RELEASE);
+
+            __atomic_store_n(&slot->in_use, DASHD_SHM_CLAIMED, __ATOMIC_RELEASE);
+            __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+            /* Another process may have claimed the same name at the same
+               time.  Every slot below ours was taken when we passed it, so
+               a racing claim below us is visible by now; the lowest slot
+               stands, and the others are given back. */
+            for(j = 0;j < i;++j)
+            {
+                if(claimed_as(&shm->slots[j], sensor_name))
+                {
+                    /* Anyone looking at ours meanwhile waits, then finds it free */
+                    __atomic_store_n(&slot->in_use, DASHD_SHM_CLAIMING, __ATOMIC_RELEASE);
+                    memset(slot->name, 0, DASHD_SHM_NAME_SIZE);
+                    __atomic_store_n(&slot->in_use, DASHD_SHM_FREE, __ATOMIC_RELEASE);
+                    return (int)j;
+                }
+            }
+
+            return (int)i;
+        }
+    }
+
+    return -1;
+}
+
+int dashd_shm_update(dashd_shm_t* shm, int slot, enum dashd_state state, const char* message)
+{
+    if(slot < 0 || (uint32_t)slot >= shm->header->slot_count)
+        return -1;
+    if(state < DASHD_STATE_HEALTHY || state > DASHD_STATE_OFFLINE)
+        return -1;
+
+    write_slot(shm, (uint32_t)slot, state, message);
+    return 0;
+}
+
+void dashd_shm_release(dashd_shm_t* shm, int slot)
+{
+    /* The Collector frees the slot once it has reported the Sensor offline */
+    dashd_shm_update(shm, slot, DASHD_STATE_OFFLINE, NULL);
+}
+
+void dashd_shm_free_slot(dashd_shm_t* shm, uint32_t slot)
+{
+    __atomic_store_n(&shm->slots[slot].in_use, DASHD_SHM_FREE, __ATOMIC_RELEASE);
+}
+
+int dashd_shm_read(dashd_shm_t* shm, uint32_t index, struct dashd_shm_slot* out)
+{
+    struct dashd_shm_slot* slot = &shm->slots[index];
+    int retries;
+
+    for(retries = 0;retries < DASHD_SHM_READ_RETRIES;++retries)
+    {
+        uint32_t before = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        uint32_t after;
+
+        if(before & 1u)
+            continue;
+
+        memcpy(out, slot, sizeof(*out));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        after = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED);
+        if(before == after)
+        {
+            out->seq = before;
+            out->name[DASHD_SHM_NAME_SIZE - 1] = '\0';
+            if(out->message_length >= DASHD_SHM_MESSAGE_SIZE)
+                out->message_length = DASHD_SHM_MESSAGE_SIZE - 1;
+            out->message[out->message_length] = '\0';
+            return 0;
+        }
+    }
+
+    return -1;
+}
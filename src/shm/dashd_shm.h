@@ -0,0 +1,91 @@
+#ifndef DASHD_SHM_H
+#define DASHD_SHM_H
+
+/*---------------------------------------------------------------------------
+ * Dash'd shared-memory Sensor slots
+ *
+ * A Collector started with --shm publishes a POSIX shared-memory segment
+ * made up of a header and an array of fixed-size Sensor slots.  A local
+ * Sensor claims a slot once, by name, and then updates its state in place
+ * as often as it likes.  The Collector scans the dirty bitmap on a short
+ * timer and forwards only the slots that actually changed.
+ *
+ * Each slot is guarded by a sequence lock: the writer bumps 'seq' to an odd
+ * value, writes the fields, and bumps it back to even.  A reader retries any
+ * copy that straddled a write.  Only one process may write a given slot.
+ *
+ * Link sensors with dashd_shm.c (and -lrt on older glibc).
+ *-------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DASHD_SHM_MAGIC         0x31485344u     /* "DSH1" */
+#define DASHD_SHM_VERSION       1u
+#define DASHD_SHM_DEFAULT_NAME  "/dash-d"
+
+#define DASHD_SHM_MAX_SLOTS     4096u
+#define DASHD_SHM_SLOT_SIZE     512u
+#define DASHD_SHM_NAME_SIZE     64u
+#define DASHD_SHM_MESSAGE_SIZE  (DASHD_SHM_SLOT_SIZE - DASHD_SHM_NAME_SIZE - 24u)
+
+/* These match SharedTypes::SensorState */
+enum dashd_state
+{
+    DASHD_STATE_UNDEFINED = 0,
+    DASHD_STATE_HEALTHY,
+    DASHD_STATE_POOR,
+    DASHD_STATE_CRITICAL,
+    DASHD_STATE_DECEASED,
+    DASHD_STATE_OFFLINE
+};
+
+struct dashd_shm_header
+{
+    uint32_t    magic;
+    uint32_t    version;
+    uint32_t    slot_count;
+    uint32_t    slot_size;
+    /* One bit per slot; set by the writer, cleared by the Collector */
+    uint64_t    dirty[DASHD_SHM_MAX_SLOTS / 64u];
+};
+
+struct dashd_shm_slot
+{
+    uint32_t    seq;            /* odd while a write is in progress */
+    uint32_t    in_use;         /* 0 = free, 1 = being claimed, 2 = claimed */
+    int64_t     updated;        /* milliseconds since the epoch */
+    uint32_t    state;          /* enum dashd_state */
+    uint32_t    message_length;
+    char        name[DASHD_SHM_NAME_SIZE];
+    char        message[DASHD_SHM_MESSAGE_SIZE];
+};
+
+typedef struct dashd_shm dashd_shm_t;
+
+/* Collector side */
+dashd_shm_t*    dashd_shm_create(const char* name, uint32_t slot_count);
+int             dashd_shm_read(dashd_shm_t* shm, uint32_t slot, struct dashd_shm_slot* out);
+uint64_t        dashd_shm_take_dirty(dashd_shm_t* shm, uint32_t word);
+void            dashd_shm_mark_dirty(dashd_shm_t* shm, uint32_t slot);
+void            dashd_shm_free_slot(dashd_shm_t* shm, uint32_t slot);
+int             dashd_shm_unlink(const char* name);
+
+/* Sensor side */
+dashd_shm_t*    dashd_shm_open(const char* name);
+int             dashd_shm_claim(dashd_shm_t* shm, const char* sensor_name);
+int             dashd_shm_update(dashd_shm_t* shm, int slot, enum dashd_state state, const char* message);
+void            dashd_shm_release(dashd_shm_t* shm, int slot);
+
+/* Both */
+uint32_t        dashd_shm_slot_count(const dashd_shm_t* shm);
+void            dashd_shm_close(dashd_shm_t* shm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DASHD_SHM_H */
@@ -0,0 +1,31 @@
+QT = core
+
+CONFIG += c++17 cmdline
+
+mac {
+    DEFINES += QT_OSX
+}
+
+unix:!mac {
+    DEFINES += QT_LINUX
+}
+
+win32 {
+    DEFINES += QT_WIN
+}
+
+# Codec compresses datagrams with zlib: the system's on Unix, and on
+# Windows the copy built into QtCore
+unix: LIBS += -lz
+win32: QT += zlib-private
+
+INCLUDEPATH += ../../common ../../common/network
+
+SOURCES += \
+    ../../common/SharedTypes.cpp \
+    ../../common/network/Codec.cpp \
+    main.cpp
+
+HEADERS += \
+    ../../common/SharedTypes.h \
+    ../../common/network/Codec.h
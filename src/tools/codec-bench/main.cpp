@@ -0,0 +1,185 @@
+//---------------------------------------------------------------------------
+// codec-bench
+//
+// Reports the bytes that Sensor reports put on the wire as plain JSON and
+// as Codec frames (compressed, and fragmented at the MTU), along with the
+// cost of encoding and decoding them.
+//
+// The corpus is either a built-in set modeled on the sample Sensors, or
+// the Sensor report files (*.json) found in a queue folder.
+//---------------------------------------------------------------------------
+
+#include <QDir>
+#include <QFile>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+
+#include "SharedTypes.h"
+#include "Codec.h"
+
+struct Sample
+{
+    QString     label;
+    QByteArray  datagram;
+};
+
+static QString raid_detail()
+{
+    // Roughly what `mdadm --detail` has to say about a degraded array
+    QString detail("raid5 'md1' is reporting 1/4 failing RAID members.\n"
+                   "        Version : 1.2\n  Creation Time : Sat Jan  4 10:12:33 2025\n"
+                   "     Raid Level : raid5\n     Array Size : 17580804096 (16.37 TiB 18.00 TB)\n"
+                   "  Used Dev Size : 5860268032 (5.46 TiB 6.00 TB)\n   Raid Devices : 4\n  Total Devices : 4\n"
+                   "    Persistence : Superblock is persistent\n  Intent Bitmap : Internal\n"
+                   "          State : clean, degraded\n Active Devices : 3\nWorking Devices : 3\n Failed Devices : 1\n"
+                   "         Layout : left-symmetric\n     Chunk Size : 512K\n\n");
+    for(int i = 0;i < 4;++i)
+        detail += QString("       %1     8       %2        %1      active sync   /dev/sd%3\n")
+                    .arg(i).arg(16 * (i + 1) + 1).arg(QChar('b' + i));
+    detail += "       -       0        0        4      faulty   /dev/sdf1\n";
+    return detail;
+}
+
+static QList<Sample> builtin_corpus()
+{
+    const std::uint64_t domain_id{12345678901234567890ULL};
+    const QString domain_name("corrin");
+    const qint64 updated{1760000000000};
+
+    QList<Sample> corpus;
+    auto add = [&](const QString& label, const QString& name, const QString& state, const QString& message) {
+        corpus.append({label, SharedTypes::format_sensor_report(domain_id, domain_name, updated, name, state, message).toUtf8()});
+    };
+
+    add("no message", "reactor.service", "healthy", QString());
+    add("free space", "_dev_sda1", "healthy", "/dev/sda1: 73% free space remaining.");
+    add("low space", "_dev_sdb1", "poor", "File system /media/data has less than 20% free space");
+    add("raid healthy", "raid_monitor_md0", "healthy", "raid1 'md0' reports 2/2 members operating normally.");
+    add("raid failing", "raid_monitor_md1", "critical", "raid5 'md1' is reporting 1/4 failing RAID members.");
+    add("raid detail", "raid_monitor_md1", "critical", raid_detail());
+    add("oversized", "journal_tail", "poor", raid_detail().repeated(4));
+
+    corpus.append({"offline", SharedTypes::format_offline_report(domain_id, domain_name, "raid_monitor_md0").toUtf8()});
+
+    return corpus;
+}
+
+static QList<Sample> folder_corpus(const QString& path)
+{
+    QList<Sample> corpus;
+
+    QDir directory(path);
+    foreach(const QString& filename, directory.entryList(QStringList() << "*.json", QDir::Files))
+    {
+        QFile file(directory.absoluteFilePath(filename));
+        if(!file.open(QIODevice::ReadOnly))
+            continue;
+
+        auto object = QJsonDocument::fromJson(file.readAll()).object();
+        if(!object.contains("sensor_name") || !object.contains("sensor_state"))
+            continue;
+
+        auto datagram = SharedTypes::format_sensor_report(1, "bench", QDateTime::currentMSecsSinceEpoch(),
+                                                          object["sensor_name"].toString(),
+                                                          object["sensor_state"].toString().toLower(),
+                                                          object["sensor_message"].toString()).toUtf8();
+        corpus.append({filename, datagram});
+    }
+
+    return corpus;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("codec-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measure Dash'd datagram sizes before and after compression.");
+    parser.addHelpOption();
+
+    QCommandLineOption mtuOption(QStringList() << "mtu", "Largest datagram to put on the wire.", "BYTES", QString::number(Codec::default_mtu));
+    parser.addOption(mtuOption);
+    QCommandLineOption queueOption(QStringList() << "q" << "queue-directory", "Use the Sensor reports in <directory> as the corpus.", "DIR");
+    parser.addOption(queueOption);
+    QCommandLineOption iterationsOption(QStringList() << "iterations", "Encode/decode passes used for timing.", "COUNT", "10000");
+    parser.addOption(iterationsOption);
+
+    parser.process(app);
+
+    const int mtu = parser.value(mtuOption).toInt();
+    const int iterations = qMax(1, parser.value(iterationsOption).toInt());
+
+    auto corpus = parser.isSet(queueOption) ? folder_corpus(parser.value(queueOption)) : builtin_corpus();
+
+    QTextStream out(stdout);
+    out << QString("%1 %2 %3 %4 %5 %6 %7\n")
+            .arg("sample", -16).arg("plain", 8).arg("wire", 8).arg("frames", 7).arg("ratio", 7)
+            .arg("enc us", 8).arg("dec us", 8);
+
+    qint64 total_plain{0};
+    qint64 total_wire{0};
+    int unsendable{0};
+    quint32 message_id{0};
+
+    foreach(const auto& sample, corpus)
+    {
+        auto frames = Codec::encode(sample.datagram, message_id++, mtu);
+
+        qint64 wire{0};
+        foreach(const auto& frame, frames)
+            wire += frame.size();
+
+        QElapsedTimer timer;
+        timer.start();
+        for(int i = 0;i < iterations;++i)
+            frames = Codec::encode(sample.datagram, message_id++, mtu);
+        auto encode_ns = timer.nsecsElapsed() / iterations;
+
+        Reassembler reassembler;
+        QByteArray decoded;
+        timer.restart();
+        for(int i = 0;i < iterations;++i)
+        {
+            foreach(const auto& frame, frames)
+                decoded = reassembler.accept(frame, "bench");
+        }
+        auto decode_ns = timer.nsecsElapsed() / iterations;
+
+        if(decoded != sample.datagram)
+        {
+            out << sample.label << ": round trip FAILED\n";
+            return 1;
+        }
+
+        // A plain datagram over the MTU would have been fragmented by IP (or lost)
+        if(sample.datagram.size() > mtu)
+            ++unsendable;
+
+        total_plain += sample.datagram.size();
+        total_wire += wire;
+
+        out << QString("%1 %2 %3 %4 %5 %6 %7\n")
+                .arg(sample.label.left(16), -16)
+                .arg(sample.datagram.size(), 8)
+                .arg(wire, 8)
+                .arg(frames.count(), 7)
+                .arg(static_cast<double>(wire) / sample.datagram.size(), 7, 'f', 2)
+                .arg(encode_ns / 1000.0, 8, 'f', 2)
+                .arg(decode_ns / 1000.0, 8, 'f', 2);
+    }
+
+    out << QString("\n%1 %2 %3       %4\n")
+            .arg("total", -16).arg(total_plain, 8).arg(total_wire, 8)
+            .arg(total_plain ? static_cast<double>(total_wire) / total_plain : 0.0, 7, 'f', 2);
+    if(unsendable)
+        out << unsendable << " plain datagram(s) exceed the " << mtu << " byte MTU.\n";
+
+    return 0;
+}
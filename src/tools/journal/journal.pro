@@ -0,0 +1,26 @@
+QT = core
+
+CONFIG += c++17 cmdline
+
+mac {
+    DEFINES += QT_OSX
+}
+
+unix:!mac {
+    DEFINES += QT_LINUX
+}
+
+win32 {
+    DEFINES += QT_WIN
+}
+
+INCLUDEPATH += ../../common
+
+SOURCES += \
+    ../../common/Journal.cpp \
+    ../../common/SharedTypes.cpp \
+    main.cpp
+
+HEADERS += \
+    ../../common/Journal.h \
+    ../../common/SharedTypes.h
@@ -0,0 +1,119 @@
+//---------------------------------------------------------------------------
+// journal
+//
+// Lists the Sensor state transitions a Collector recorded (see Collector
+// --journal) over a span of time, optionally for a single Sensor.  The
+// journal may be read while the Collector is still writing it.
+//---------------------------------------------------------------------------
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+
+#include "SharedTypes.h"
+#include "Journal.h"
+
+static QString state_name(quint8 state)
+{
+    auto text = SharedTypes::MsgState2Text.value(static_cast<SharedTypes::SensorState>(state));
+    return text.isEmpty() ? QString("(none)") : text;
+}
+
+// Accepts an ISO 8601 date/time, or a number of hours before now
+static bool parse_time(const QString& text, qint64& msecs)
+{
+    bool ok;
+    auto hours = text.toDouble(&ok);
+    if(ok)
+    {
+        msecs = QDateTime::currentMSecsSinceEpoch() - static_cast<qint64>(hours * 3600 * 1000);
+        return true;
+    }
+
+    auto when = QDateTime::fromString(text, Qt::ISODate);
+    if(!when.isValid())
+        return false;
+
+    msecs = when.toMSecsSinceEpoch();
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("journal");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("List the Sensor state transitions in a Dash'd Collector journal.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("directory", "Journal folder given to the Collector's --journal option.");
+
+    QCommandLineOption fromOption(QStringList() << "from", "Start of the span: an ISO 8601 time, or hours ago.", "TIME", "24");
+    parser.addOption(fromOption);
+    QCommandLineOption toOption(QStringList() << "to", "End of the span: an ISO 8601 time, or hours ago.", "TIME", "0");
+    parser.addOption(toOption);
+    QCommandLineOption sensorOption(QStringList() << "sensor", "Only list transitions of the Sensor named <name>.", "NAME");
+    parser.addOption(sensorOption);
+    QCommandLineOption csvOption(QStringList() << "csv", "Write comma-separated values.");
+    parser.addOption(csvOption);
+
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    if(parser.positionalArguments().count() != 1)
+        parser.showHelp(1);
+
+    qint64 from, to;
+    if(!parse_time(parser.value(fromOption), from) || !parse_time(parser.value(toOption), to))
+    {
+        err << "--from and --to take an ISO 8601 time or a number of hours\n";
+        return 1;
+    }
+
+    Journal journal(parser.positionalArguments().first());
+    if(!journal.open(true))
+    {
+        err << "could not open the journal: " << journal.error_string() << "\n";
+        return 1;
+    }
+
+    quint64 sensor_id{0};
+    if(parser.isSet(sensorOption))
+        sensor_id = Journal::sensor_id(parser.value(sensorOption));
+
+    QElapsedTimer timer;
+    timer.start();
+    auto records = journal.query(from, to, sensor_id);
+    auto elapsed = timer.nsecsElapsed();
+
+    const bool csv = parser.isSet(csvOption);
+    if(csv)
+        out << "time,sensor,from,to,message_hash\n";
+
+    foreach(const auto& record, records)
+    {
+        auto when = QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(record.timestamp)).toString(Qt::ISODateWithMs);
+        auto name = journal.sensor_name(record.sensor_id);
+        if(name.isEmpty())
+            name = QString("%1").arg(record.sensor_id, 16, 16, QChar('0'));
+        auto hash = QString("%1").arg(record.message_hash, 8, 16, QChar('0'));
+
+        if(csv)
+            out << when << ",\"" << QString(name).replace('"', "\"\"") << "\"," << state_name(record.old_state) << ","
+                << state_name(record.new_state) << "," << hash << "\n";
+        else
+            out << when << "  " << name << ": " << state_name(record.old_state) << " -> "
+                << state_name(record.new_state) << "  [" << hash << "]\n";
+    }
+
+    err << QString("%1 transitions (of %2 in %3 segments) found in %4 ms\n")
+               .arg(records.count()).arg(journal.records()).arg(journal.segments())
+               .arg(elapsed / 1e6, 0, 'f', 2);
+
+    return 0;
+}
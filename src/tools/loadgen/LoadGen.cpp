@@ -0,0 +1,200 @@
+#include <QDateTime>
+#include <QTextStream>
+
+#include "LoadGen.h"
+
+LoadGen::LoadGen(const Settings& settings, SenderPtr sender, QObject* parent)
+    : QObject(parent),
+      m_settings(settings),
+      m_sender(sender),
+      m_random(settings.seed)
+{
+    std::vector<double> weights;
+    foreach(const auto& entry, m_settings.mix)
+        weights.push_back(entry.second);
+    m_state_pick = std::discrete_distribution<>(weights.begin(), weights.end());
+
+    m_states.assign(static_cast<size_t>(m_settings.domains * m_settings.sensors), SharedTypes::SensorState::Undefined);
+
+    m_tick.setTimerType(Qt::PreciseTimer);
+    m_tick.setInterval(tick_interval);
+    connect(&m_tick, &QTimer::timeout, this, &LoadGen::slot_tick);
+
+    m_storm.setInterval(m_settings.storm_interval * 1000);
+    connect(&m_storm, &QTimer::timeout, this, &LoadGen::slot_storm);
+
+    m_report.setInterval(m_settings.report * 1000);
+    connect(&m_report, &QTimer::timeout, this, &LoadGen::slot_report);
+}
+
+void LoadGen::start()
+{
+    m_clock.start();
+
+    // Every Sensor introduces itself, as it would when its Collector starts
+    for(int d = 0;d < m_settings.domains;++d)
+    {
+        for(int s = 0;s < m_settings.sensors;++s)
+        {
+            auto state = pick_state();
+            m_states[static_cast<size_t>(d * m_settings.sensors + s)] = state;
+            transmit(sensor_report(d, s, state));
+        }
+    }
+
+    m_tick.start();
+    if(m_settings.storm_interval > 0)
+        m_storm.start();
+    if(m_settings.report > 0)
+        m_report.start();
+    if(m_settings.duration > 0)
+        QTimer::singleShot(m_settings.duration * 1000, this, &LoadGen::slot_finish);
+}
+
+QByteArray LoadGen::sensor_report(int domain, int sensor, SharedTypes::SensorState state) const
+{
+    auto state_text = SharedTypes::MsgState2Text[state];
+    return SharedTypes::format_sensor_report(1000000 + domain, QString("loadgen-%1").arg(domain),
+                                             QDateTime::currentMSecsSinceEpoch(),
+                                             QString("sensor_%1").arg(sensor), state_text,
+                                             QString("sensor_%1 on loadgen-%2 is %3").arg(sensor).arg(domain).arg(state_text)).toUtf8();
+}
+
+QByteArray LoadGen::offline_report(int domain, int sensor) const
+{
+    return SharedTypes::format_offline_report(1000000 + domain, QString("loadgen-%1").arg(domain),
+                                              QString("sensor_%1").arg(sensor)).toUtf8();
+}
+
+SharedTypes::SensorState LoadGen::pick_state()
+{
+    return m_settings.mix[m_state_pick(m_random)].first;
+}
+
+void LoadGen::transmit(const QByteArray& datagram)
+{
+    ++m_generated;
+
+    if(m_settings.loss > 0.0 && m_chance(m_random) < m_settings.loss)
+    {
+        ++m_lost;
+        return;
+    }
+
+    if(m_settings.reorder > 0.0 && m_chance(m_random) < m_settings.reorder)
+    {
+        // Goes out after the rest of this tick's datagrams
+        ++m_reordered;
+        m_held.append(datagram);
+        return;
+    }
+
+    m_sender->send_datagram(datagram);
+}
+
+void LoadGen::slot_tick()
+{
+    const auto sensor_count = m_settings.domains * m_settings.sensors;
+
+    m_owed += static_cast<double>(sensor_count) * tick_interval / m_settings.interval;
+
+    std::uniform_int_distribution<> sensor_pick(0, sensor_count - 1);
+
+    auto held = m_held;
+    m_held.clear();
+
+    while(m_owed >= 1.0)
+    {
+        m_owed -= 1.0;
+
+        auto index = sensor_pick(m_random);
+        auto domain = index / m_settings.sensors;
+        auto sensor = index % m_settings.sensors;
+        auto& state = m_states[static_cast<size_t>(index)];
+
+        if(state != SharedTypes::SensorState::Offline && m_chance(m_random) < m_settings.churn)
+        {
+            ++m_offlines;
+            state = SharedTypes::SensorState::Offline;
+            transmit(offline_report(domain, sensor));
+        }
+        else
+        {
+            // An offline Sensor that updates has come back
+            state = pick_state();
+            transmit(sensor_report(domain, sensor, state));
+        }
+    }
+
+    foreach(const auto& datagram, held)
+        m_sender->send_datagram(datagram);
+}
+
+void LoadGen::slot_storm()
+{
+    ++m_storms;
+
+    // A crowd of Dashboards joins at once...
+    for(int i = 0;i < m_settings.storm_size;++i)
+    {
+        auto initialize = QString("{ \"dashboard_id\" : \"%1\", \"action\" : \"initialize\" }")
+            .arg(static_cast<qint64>(m_random()));
+        m_sender->send_datagram(initialize.toUtf8());
+    }
+
+    // ...and every emulated Collector answers with everything it knows
+    for(int d = 0;d < m_settings.domains;++d)
+    {
+        for(int s = 0;s < m_settings.sensors;++s)
+        {
+            auto state = m_states[static_cast<size_t>(d * m_settings.sensors + s)];
+            if(state != SharedTypes::SensorState::Offline)
+                transmit(sensor_report(d, s, state));
+        }
+    }
+}
+
+void LoadGen::slot_report()
+{
+    auto now = m_clock.elapsed();
+    auto sent = m_sender->sent();
+
+    auto elapsed = now - m_last_report;
+    auto rate = elapsed ? (sent - m_last_sent) * 1000.0 / elapsed : 0.0;
+
+    QTextStream out(stdout);
+    out << QString("%1s  generated %2  lost %3  reordered %4  offline %5  storms %6  "
+                   "sent %7  dropped %8  errors %9  pending %10  rate %11/s\n")
+            .arg(now / 1000)
+            .arg(m_generated).arg(m_lost).arg(m_reordered).arg(m_offlines).arg(m_storms)
+            .arg(sent).arg(m_sender->dropped()).arg(m_sender->errors()).arg(m_sender->pending())
+            .arg(rate, 0, 'f', 0);
+
+    m_last_report = now;
+    m_last_sent = sent;
+}
+
+void LoadGen::slot_finish()
+{
+    m_tick.stop();
+    m_storm.stop();
+    m_report.stop();
+
+    foreach(const auto& datagram, m_held)
+        m_sender->send_datagram(datagram);
+    m_held.clear();
+
+    m_sender->flush();
+
+    auto elapsed = m_clock.elapsed();
+    QTextStream out(stdout);
+    out << QString("\n%1 datagrams generated in %2s; %3 sent (%4/s average), %5 lost by design, %6 dropped by the Sender\n")
+            .arg(m_generated)
+            .arg(elapsed / 1000.0, 0, 'f', 1)
+            .arg(m_sender->sent())
+            .arg(elapsed ? m_sender->sent() * 1000.0 / elapsed : 0.0, 0, 'f', 0)
+            .arg(m_lost)
+            .arg(m_sender->dropped());
+
+    emit signal_finished();
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <random>
+#include <vector>
+
+#include <QList>
+#include <QTimer>
+#include <QString>
+#include <QByteArray>
+#include <QElapsedTimer>
+
+#include "SharedTypes.h"
+#include "Sender.h"
+
+//---------------------------------------------------------------------------
+// LoadGen
+//
+// Emulates a ring of Collectors: N Domains of M Sensors each, changing
+// state at a configurable cadence and mix, going offline and coming back,
+// and answering bursts of Dashboard initialize requests.  Datagrams can be
+// dropped or reordered before they reach the Sender, to see how Dashboards
+// cope with an imperfect network.
+//---------------------------------------------------------------------------
+
+class LoadGen : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Settings
+    {
+        int         domains{100};
+        int         sensors{50};
+        int         interval{10000};        // mean milliseconds between updates of one Sensor
+        double      churn{0.01};            // chance an update takes its Sensor offline
+        QList<QPair<SharedTypes::SensorState, int>> mix;    // state and relative weight
+
+        int         storm_interval{0};      // seconds between initialize storms (0 = none)
+        int         storm_size{50};         // initialize requests per storm
+
+        double      loss{0.0};              // chance a datagram is dropped
+        double      reorder{0.0};           // chance a datagram is held back a tick
+
+        int         duration{0};            // seconds to run (0 = until interrupted)
+        int         report{5};              // seconds between progress lines
+        std::uint32_t seed{1};
+    };
+
+    LoadGen(const Settings& settings, SenderPtr sender, QObject* parent = nullptr);
+
+    void        start();
+
+signals:
+    void        signal_finished();
+
+private slots:
+    void        slot_tick();
+    void        slot_storm();
+    void        slot_report();
+    void        slot_finish();
+
+private:    // typedefs and enums
+    // How often the generator wakes to emit its share of updates
+    static constexpr int tick_interval{10};     // milliseconds
+
+private:    // methods
+    QByteArray  sensor_report(int domain, int sensor, SharedTypes::SensorState state) const;
+    QByteArray  offline_report(int domain, int sensor) const;
+    SharedTypes::SensorState pick_state();
+    void        transmit(const QByteArray& datagram);
+
+private:    // data members
+    Settings    m_settings;
+    SenderPtr   m_sender;
+
+    std::mt19937 m_random;
+    std::discrete_distribution<> m_state_pick;
+    std::uniform_real_distribution<> m_chance{0.0, 1.0};
+
+    // Last state reported for each Sensor, [domain * sensors + sensor]
+    std::vector<SharedTypes::SensorState> m_states;
+
+    // Updates owed but not yet emitted (the fraction left over from each tick)
+    double      m_owed{0.0};
+    QList<QByteArray> m_held;
+
+    QTimer      m_tick;
+    QTimer      m_storm;
+    QTimer      m_report;
+
+    QElapsedTimer m_clock;
+    qint64      m_last_report{0};
+    quint64     m_last_sent{0};
+
+    quint64     m_generated{0};
+    quint64     m_lost{0};
+    quint64     m_reordered{0};
+    quint64     m_offlines{0};
+    quint64     m_storms{0};
+};
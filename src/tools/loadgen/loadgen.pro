@@ -0,0 +1,37 @@
+QT = core network
+
+CONFIG += c++17 cmdline
+
+mac {
+    DEFINES += QT_OSX
+}
+
+unix:!mac {
+    DEFINES += QT_LINUX
+}
+
+win32 {
+    DEFINES += QT_WIN
+}
+
+# Codec compresses datagrams with zlib: the system's on Unix, and on
+# Windows the copy built into QtCore
+unix: LIBS += -lz
+win32: QT += zlib-private
+
+INCLUDEPATH += ../../common ../../common/network
+
+SOURCES += \
+    ../../common/SharedTypes.cpp \
+    ../../common/Trace.cpp \
+    ../../common/network/Codec.cpp \
+    ../../common/network/Sender.cpp \
+    LoadGen.cpp \
+    main.cpp
+
+HEADERS += \
+    ../../common/SharedTypes.h \
+    ../../common/Trace.h \
+    ../../common/network/Codec.h \
+    ../../common/network/Sender.h \
+    LoadGen.h
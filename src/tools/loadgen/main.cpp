@@ -0,0 +1,122 @@
+//---------------------------------------------------------------------------
+// loadgen
+//
+// Puts a synthetic ring's worth of Collector traffic on a multicast group,
+// so Dashboards and Collectors can be watched under the load of thousands
+// of Domains without deploying them.  Point it at a private group unless
+// you want your real Dashboards to see it, too.
+//---------------------------------------------------------------------------
+
+#include <QTextStream>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+
+#include "SharedTypes.h"
+#include "Sender.h"
+#include "LoadGen.h"
+
+static bool parse_mix(const QString& text, QList<QPair<SharedTypes::SensorState, int>>& mix)
+{
+    foreach(const auto& entry, text.split(','))
+    {
+        if(entry.trimmed().isEmpty())
+            continue;
+
+        auto parts = entry.split(':');
+        auto state_text = parts[0].trimmed().toLower();
+        if(parts.count() != 2 || !SharedTypes::MsgText2State.contains(state_text) || state_text == "offline")
+            return false;
+
+        bool ok{false};
+        auto weight = parts[1].toInt(&ok);
+        if(!ok || weight < 0)
+            return false;
+
+        mix.append(qMakePair(SharedTypes::MsgText2State[state_text], weight));
+    }
+
+    return !mix.isEmpty();
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("loadgen");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Emulate a ring of Dash'd Collectors.");
+    parser.addHelpOption();
+
+    QCommandLineOption portOption(QStringList() << "P" << "port", "Multicast group port.", "PORT", QString::number(SharedTypes::MULTICAST_PORT));
+    parser.addOption(portOption);
+    QCommandLineOption ip4Option(QStringList() << "ipv4", "IPv4 multicast group (empty to disable).", "ADDRESS", SharedTypes::MULTICAST_IPV4);
+    parser.addOption(ip4Option);
+    QCommandLineOption ip6Option(QStringList() << "ipv6", "IPv6 multicast group (empty to disable).", "ADDRESS", SharedTypes::MULTICAST_IPV6);
+    parser.addOption(ip6Option);
+
+    QCommandLineOption domainsOption(QStringList() << "d" << "domains", "Domains to emulate.", "COUNT", "100");
+    parser.addOption(domainsOption);
+    QCommandLineOption sensorsOption(QStringList() << "s" << "sensors", "Sensors per Domain.", "COUNT", "50");
+    parser.addOption(sensorsOption);
+    QCommandLineOption intervalOption(QStringList() << "interval", "Mean milliseconds between updates from one Sensor.", "MS", "10000");
+    parser.addOption(intervalOption);
+    QCommandLineOption mixOption(QStringList() << "mix", "Weights of the states an update reports.", "STATE:WEIGHT,...", "healthy:80,poor:15,critical:5");
+    parser.addOption(mixOption);
+    QCommandLineOption churnOption(QStringList() << "churn", "Percent of updates that take their Sensor offline.", "PERCENT", "1");
+    parser.addOption(churnOption);
+    QCommandLineOption stormIntervalOption(QStringList() << "storm-interval", "Seconds between initialize storms (0 = none).", "SECONDS", "0");
+    parser.addOption(stormIntervalOption);
+    QCommandLineOption stormSizeOption(QStringList() << "storm-size", "Initialize requests in each storm.", "COUNT", "50");
+    parser.addOption(stormSizeOption);
+    QCommandLineOption lossOption(QStringList() << "loss", "Percent of datagrams to drop.", "PERCENT", "0");
+    parser.addOption(lossOption);
+    QCommandLineOption reorderOption(QStringList() << "reorder", "Percent of datagrams to deliver late.", "PERCENT", "0");
+    parser.addOption(reorderOption);
+    QCommandLineOption sendRateOption(QStringList() << "send-rate", "Most datagrams per second the Sender may transmit.", "RATE", "100000");
+    parser.addOption(sendRateOption);
+    QCommandLineOption durationOption(QStringList() << "duration", "Seconds to run (0 = until interrupted).", "SECONDS", "60");
+    parser.addOption(durationOption);
+    QCommandLineOption reportOption(QStringList() << "report", "Seconds between progress lines.", "SECONDS", "5");
+    parser.addOption(reportOption);
+    QCommandLineOption seedOption(QStringList() << "seed", "Seed for the random stream.", "SEED", "1");
+    parser.addOption(seedOption);
+
+    parser.process(app);
+
+    LoadGen::Settings settings;
+    settings.domains = qMax(1, parser.value(domainsOption).toInt());
+    settings.sensors = qMax(1, parser.value(sensorsOption).toInt());
+    settings.interval = qMax(1, parser.value(intervalOption).toInt());
+    settings.churn = qBound(0.0, parser.value(churnOption).toDouble() / 100.0, 1.0);
+    settings.storm_interval = qMax(0, parser.value(stormIntervalOption).toInt());
+    settings.storm_size = qMax(0, parser.value(stormSizeOption).toInt());
+    settings.loss = qBound(0.0, parser.value(lossOption).toDouble() / 100.0, 1.0);
+    settings.reorder = qBound(0.0, parser.value(reorderOption).toDouble() / 100.0, 1.0);
+    settings.duration = qMax(0, parser.value(durationOption).toInt());
+    settings.report = qMax(0, parser.value(reportOption).toInt());
+    settings.seed = parser.value(seedOption).toUInt();
+
+    if(!parse_mix(parser.value(mixOption), settings.mix))
+    {
+        QTextStream(stderr) << "--mix must list states and weights, e.g. healthy:80,poor:15,critical:5\n";
+        return 1;
+    }
+
+    auto sender = SenderPtr(new Sender(parser.value(portOption).toUShort(),
+                                       parser.value(ip4Option), parser.value(ip6Option)));
+    auto send_rate = qMax(1, parser.value(sendRateOption).toInt());
+    sender->set_rate(send_rate, qMax(send_rate / 8, 64));
+    // Let the queue absorb a full rebroadcast of every emulated Sensor
+    sender->set_queue_limit(qMax(4096, settings.domains * settings.sensors * 2));
+
+    QTextStream(stdout) << QString("Emulating %1 domains x %2 sensors (%3 updates/s expected)\n")
+                            .arg(settings.domains).arg(settings.sensors)
+                            .arg(settings.domains * settings.sensors * 1000.0 / settings.interval, 0, 'f', 0);
+
+    LoadGen loadgen(settings, sender);
+    QObject::connect(&loadgen, &LoadGen::signal_finished, &app, &QCoreApplication::quit, Qt::QueuedConnection);
+    loadgen.start();
+
+    return app.exec();
+}
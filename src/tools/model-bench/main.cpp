@@ -0,0 +1,215 @@
+//---------------------------------------------------------------------------
+// model-bench
+//
+// Drives the headless Dashboard model with a stream of Collector datagrams
+// and reports how quickly it keeps up: decode throughput, the latency of
+// each update, and what the model costs in memory per Sensor.
+//
+// The stream is either synthetic (N Domains of M Sensors, changing state
+// at random) or a recording with one datagram per line.
+//---------------------------------------------------------------------------
+
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include <QFile>
+#include <QThread>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+
+#include "SharedTypes.h"
+#include "Model.h"
+
+static const QStringList states{"healthy", "healthy", "healthy", "poor", "critical"};
+
+static QList<QByteArray> synthetic_stream(int domains, int sensors, int updates, std::uint32_t seed)
+{
+    std::mt19937 rd_mt(seed);
+    std::uniform_int_distribution<> domain_pick(0, domains - 1);
+    std::uniform_int_distribution<> sensor_pick(0, sensors - 1);
+    std::uniform_int_distribution<> state_pick(0, states.count() - 1);
+
+    auto report = [](int d, int s, const QString& state) {
+        return SharedTypes::format_sensor_report(1000000 + d, QString("host-%1").arg(d), QDateTime::currentMSecsSinceEpoch(),
+                                                 QString("sensor_%1").arg(s), state,
+                                                 QString("sensor_%1 on host-%2 is %3").arg(s).arg(d).arg(state)).toUtf8();
+    };
+
+    QList<QByteArray> stream;
+    stream.reserve(domains * sensors + updates);
+
+    // Every Sensor introduces itself first, as it would after an initialize request
+    for(int d = 0;d < domains;++d)
+        for(int s = 0;s < sensors;++s)
+            stream.append(report(d, s, "healthy"));
+
+    for(int i = 0;i < updates;++i)
+        stream.append(report(domain_pick(rd_mt), sensor_pick(rd_mt), states[state_pick(rd_mt)]));
+
+    return stream;
+}
+
+static QList<QByteArray> recorded_stream(const QString& path)
+{
+    QList<QByteArray> stream;
+
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly))
+        return stream;
+
+    while(!file.atEnd())
+    {
+        auto line = file.readLine().trimmed();
+        if(!line.isEmpty())
+            stream.append(line);
+    }
+
+    return stream;
+}
+
+static qint64 resident_bytes()
+{
+#ifdef QT_LINUX
+    QFile statm("/proc/self/statm");
+    if(statm.open(QIODevice::ReadOnly))
+    {
+        auto fields = statm.readAll().split(' ');
+        if(fields.count() > 1)
+            return fields[1].toLongLong() * 4096;
+    }
+#endif
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("model-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measure how quickly the Dash'd model absorbs Collector datagrams.");
+    parser.addHelpOption();
+
+    QCommandLineOption domainsOption(QStringList() << "d" << "domains", "Synthetic Domains to emulate.", "COUNT", "100");
+    parser.addOption(domainsOption);
+    QCommandLineOption sensorsOption(QStringList() << "s" << "sensors", "Synthetic Sensors per Domain.", "COUNT", "50");
+    parser.addOption(sensorsOption);
+    QCommandLineOption updatesOption(QStringList() << "u" << "updates", "Synthetic state changes after the initial population.", "COUNT", "200000");
+    parser.addOption(updatesOption);
+    QCommandLineOption seedOption(QStringList() << "seed", "Seed for the synthetic stream.", "SEED", "1");
+    parser.addOption(seedOption);
+    QCommandLineOption fileOption(QStringList() << "f" << "file", "Replay the datagrams in <file> (one per line) instead.", "FILE");
+    parser.addOption(fileOption);
+    QCommandLineOption rateOption(QStringList() << "r" << "rate", "Datagrams per second to deliver (0 = as fast as possible).", "RATE", "0");
+    parser.addOption(rateOption);
+    QCommandLineOption tableOption(QStringList() << "table-only", "Keep only the flat Sensor table, without a QObject per Domain and Sensor.");
+    parser.addOption(tableOption);
+
+    parser.process(app);
+
+    QTextStream out(stdout);
+
+    auto baseline = resident_bytes();
+
+    QList<QByteArray> stream;
+    if(parser.isSet(fileOption))
+    {
+        stream = recorded_stream(parser.value(fileOption));
+        if(stream.isEmpty())
+        {
+            out << "No datagrams found in " << parser.value(fileOption) << "\n";
+            return 1;
+        }
+    }
+    else
+        stream = synthetic_stream(qMax(1, parser.value(domainsOption).toInt()),
+                                  qMax(1, parser.value(sensorsOption).toInt()),
+                                  qMax(0, parser.value(updatesOption).toInt()),
+                                  parser.value(seedOption).toUInt());
+
+    // Don't charge the model for the stream it is fed
+    auto stream_bytes = resident_bytes() - baseline;
+
+    const auto rate = parser.value(rateOption).toDouble();
+    const qint64 interval_ns = rate > 0.0 ? static_cast<qint64>(1e9 / rate) : 0;
+
+    Model model;
+    // Measure the model, not its limits
+    model.set_max_domains(0);
+    model.set_max_sensors(0);
+    model.set_objects_enabled(!parser.isSet(tableOption));
+
+    // Sized (and so touched) up front, to keep it out of the model's footprint
+    std::vector<qint64> latencies(static_cast<size_t>(stream.count()), 0);
+    int rejected{0};
+
+    auto before_model = resident_bytes();
+
+    QElapsedTimer clock;
+    QElapsedTimer timer;
+    clock.start();
+
+    qint64 busy_ns{0};
+    for(int i = 0;i < stream.count();++i)
+    {
+        if(interval_ns)
+        {
+            auto due = i * interval_ns;
+            auto now = clock.nsecsElapsed();
+            if(due > now)
+                QThread::usleep(static_cast<unsigned long>((due - now) / 1000));
+        }
+
+        timer.start();
+        if(!model.process_datagram(stream[i]))
+            ++rejected;
+        auto elapsed = timer.nsecsElapsed();
+
+        // No event loop here; take the table's changes as a consumer would
+        if((i & 1023) == 1023)
+            model.slot_flush_changes();
+
+        latencies[static_cast<size_t>(i)] = elapsed;
+        busy_ns += elapsed;
+    }
+
+    auto wall_ns = clock.nsecsElapsed();
+    auto model_bytes = resident_bytes() - before_model;
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double p) {
+        if(latencies.empty())
+            return 0.0;
+        auto index = static_cast<size_t>(p * (latencies.size() - 1));
+        return latencies[index] / 1000.0;
+    };
+
+    auto sensors = model.sensor_count();
+
+    out << QString("datagrams    %1 (%2 rejected)\n").arg(stream.count()).arg(rejected);
+    out << QString("model        %1 domains, %2 sensors\n").arg(model.domain_count()).arg(sensors);
+    out << QString("repeats      %1 of %2 sensor reports dropped\n").arg(model.repeats_dropped()).arg(model.reports_checked());
+    out << QString("stale        %1 out-of-order sensor reports dropped\n").arg(model.stale_dropped());
+    out << QString("wall         %1 s\n").arg(wall_ns / 1e9, 0, 'f', 3);
+    out << QString("throughput   %1 datagrams/s delivered, %2 datagrams/s decoded\n")
+            .arg(wall_ns ? stream.count() * 1e9 / wall_ns : 0.0, 0, 'f', 0)
+            .arg(busy_ns ? stream.count() * 1e9 / busy_ns : 0.0, 0, 'f', 0);
+    out << QString("latency us   p50 %1  p90 %2  p99 %3  max %4\n")
+            .arg(percentile(0.50), 0, 'f', 2)
+            .arg(percentile(0.90), 0, 'f', 2)
+            .arg(percentile(0.99), 0, 'f', 2)
+            .arg(percentile(1.00), 0, 'f', 2);
+    if(model_bytes > 0 && sensors)
+        out << QString("memory       %1 KiB for the model, %2 bytes per sensor (stream held %3 KiB, model estimates %4 KiB)\n")
+                .arg(model_bytes / 1024)
+                .arg(model_bytes / sensors)
+                .arg(stream_bytes / 1024)
+                .arg(model.memory_estimate() / 1024);
+
+    return 0;
+}
@@ -0,0 +1,24 @@
+QT = core
+
+CONFIG += c++17 cmdline
+
+mac {
+    DEFINES += QT_OSX
+}
+
+unix:!mac {
+    DEFINES += QT_LINUX
+}
+
+win32 {
+    DEFINES += QT_WIN
+}
+
+INCLUDEPATH += ../../common ../../model
+
+LIBS += -L$$OUT_PWD/../../model -ldashd-model
+win32: PRE_TARGETDEPS += $$OUT_PWD/../../model/dashd-model.lib
+else: PRE_TARGETDEPS += $$OUT_PWD/../../model/libdashd-model.a
+
+SOURCES += \
+    main.cpp
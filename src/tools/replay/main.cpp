@@ -0,0 +1,249 @@
+//---------------------------------------------------------------------------
+// replay
+//
+// Plays a Capture (see Dashboard --capture) back, either into the headless
+// model, where decode and update throughput are measured, or onto a
+// multicast group for a live Dashboard to absorb.  Playback runs at the
+// original pace or as fast as possible.
+//
+// Against a baseline from an earlier run, replay exits with status 2 if
+// throughput has fallen by more than --threshold percent, so a capture and
+// a baseline make a performance regression test.
+//---------------------------------------------------------------------------
+
+#include <vector>
+#include <algorithm>
+
+#include <QFile>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+
+#include "SharedTypes.h"
+#include "Capture.h"
+#include "Codec.h"
+#include "Sender.h"
+#include "Model.h"
+
+enum ExitCode {
+    Success = 0,
+    Failure = 1,
+    Regression = 2
+};
+
+// Sleep until 'record_time' (capture clock) lines up with the replay clock
+static void pace(qint64 first_record, qint64 record_time, const QElapsedTimer& clock)
+{
+    auto due_us = record_time - first_record;
+    auto now_us = clock.nsecsElapsed() / 1000;
+    if(due_us > now_us)
+        QThread::usleep(static_cast<unsigned long>(due_us - now_us));
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("replay");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Replay a Dash'd ring capture into the model or onto a multicast group.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("capture", "Capture file written by a Dashboard's --capture option.");
+
+    QCommandLineOption realtimeOption(QStringList() << "realtime", "Keep the capture's original timing (default: as fast as possible).");
+    parser.addOption(realtimeOption);
+    QCommandLineOption loopsOption(QStringList() << "loops", "Times to play the capture.", "COUNT", "1");
+    parser.addOption(loopsOption);
+
+    QCommandLineOption sendOption(QStringList() << "send", "Transmit to a multicast group instead of the model.");
+    parser.addOption(sendOption);
+    QCommandLineOption portOption(QStringList() << "P" << "port", "Multicast group port for --send.", "PORT", QString::number(SharedTypes::MULTICAST_PORT));
+    parser.addOption(portOption);
+    QCommandLineOption ip4Option(QStringList() << "ipv4", "IPv4 multicast group for --send (empty to disable).", "ADDRESS", SharedTypes::MULTICAST_IPV4);
+    parser.addOption(ip4Option);
+    QCommandLineOption ip6Option(QStringList() << "ipv6", "IPv6 multicast group for --send (empty to disable).", "ADDRESS", SharedTypes::MULTICAST_IPV6);
+    parser.addOption(ip6Option);
+
+    QCommandLineOption baselineOption(QStringList() << "baseline", "Compare throughput with the results in <file>.", "FILE");
+    parser.addOption(baselineOption);
+    QCommandLineOption thresholdOption(QStringList() << "threshold", "Percent drop from the baseline that counts as a regression.", "PERCENT", "10");
+    parser.addOption(thresholdOption);
+    QCommandLineOption saveOption(QStringList() << "save-baseline", "Write this run's results to <file>.", "FILE");
+    parser.addOption(saveOption);
+
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    if(parser.positionalArguments().count() != 1)
+    {
+        parser.showHelp(Failure);
+    }
+
+    const auto path = parser.positionalArguments().first();
+    const bool realtime = parser.isSet(realtimeOption);
+    const int loops = qMax(1, parser.value(loopsOption).toInt());
+
+    // Load the capture up front so file I/O isn't part of what we measure
+    QList<CaptureReader::Record> records;
+    {
+        CaptureReader reader;
+        if(!reader.open(path))
+        {
+            err << path << " is not a Dash'd capture\n";
+            return Failure;
+        }
+
+        CaptureReader::Record record;
+        while(reader.next(record))
+            records.append(record);
+    }
+
+    if(records.isEmpty())
+    {
+        err << path << " holds no datagrams\n";
+        return Failure;
+    }
+
+    if(parser.isSet(sendOption))
+    {
+        Sender sender(parser.value(portOption).toUShort(), parser.value(ip4Option), parser.value(ip6Option));
+        sender.set_queue_limit(records.count());
+
+        QElapsedTimer clock;
+        clock.start();
+        for(int loop = 0;loop < loops;++loop)
+        {
+            QElapsedTimer loop_clock;
+            loop_clock.start();
+            foreach(const auto& record, records)
+            {
+                if(realtime)
+                {
+                    pace(records.first().timestamp, record.timestamp, loop_clock);
+                    sender.send_datagram(record.datagram);
+                    sender.flush();
+                }
+                else
+                    sender.send_datagram(record.datagram);
+            }
+            sender.flush();
+        }
+
+        auto elapsed = clock.nsecsElapsed();
+        out << QString("sent %1 of %2 datagrams in %3 s (%4/s), %5 errors\n")
+                .arg(sender.sent()).arg(records.count() * loops)
+                .arg(elapsed / 1e9, 0, 'f', 3)
+                .arg(elapsed ? sender.sent() * 1e9 / elapsed : 0.0, 0, 'f', 0)
+                .arg(sender.errors());
+        return sender.errors() ? Failure : Success;
+    }
+
+    Model model;
+    // A capture may hold more than one Dashboard would keep; decode all of it
+    model.set_max_domains(0);
+    model.set_max_sensors(0);
+    Reassembler reassembler;
+
+    std::vector<qint64> latencies(static_cast<size_t>(records.count() * loops), 0);
+    size_t next_latency{0};
+    int rejected{0};
+    qint64 busy_ns{0};
+
+    QElapsedTimer clock;
+    QElapsedTimer timer;
+    clock.start();
+
+    for(int loop = 0;loop < loops;++loop)
+    {
+        QElapsedTimer loop_clock;
+        loop_clock.start();
+        foreach(const auto& record, records)
+        {
+            if(realtime)
+                pace(records.first().timestamp, record.timestamp, loop_clock);
+
+            timer.start();
+            auto payload = record.datagram;
+            if(Codec::is_framed(payload))
+                payload = reassembler.accept(payload, QString::number(record.origin));
+            if(!payload.isEmpty() && !model.process_datagram(payload))
+                ++rejected;
+            auto elapsed = timer.nsecsElapsed();
+
+            latencies[next_latency++] = elapsed;
+            busy_ns += elapsed;
+        }
+    }
+
+    auto wall_ns = clock.nsecsElapsed();
+    auto total = records.count() * loops;
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double p) {
+        return latencies[static_cast<size_t>(p * (latencies.size() - 1))] / 1000.0;
+    };
+
+    auto throughput = busy_ns ? total * 1e9 / busy_ns : 0.0;
+    auto span_s = (records.last().timestamp - records.first().timestamp) / 1e6;
+
+    out << QString("capture      %1 datagrams over %2 s\n").arg(records.count()).arg(span_s, 0, 'f', 3);
+    out << QString("replayed     %1 datagrams in %2 s (%3 rejected, %4 invalid frames)\n")
+            .arg(total).arg(wall_ns / 1e9, 0, 'f', 3).arg(rejected).arg(reassembler.invalid());
+    out << QString("model        %1 domains, %2 sensors\n").arg(model.domain_count()).arg(model.sensor_count());
+    out << QString("throughput   %1 datagrams/s decoded\n").arg(throughput, 0, 'f', 0);
+    out << QString("latency us   p50 %1  p90 %2  p99 %3  max %4\n")
+            .arg(percentile(0.50), 0, 'f', 2)
+            .arg(percentile(0.90), 0, 'f', 2)
+            .arg(percentile(0.99), 0, 'f', 2)
+            .arg(percentile(1.00), 0, 'f', 2);
+
+    QJsonObject results;
+    results["datagrams"] = total;
+    results["throughput"] = throughput;
+    results["p50_us"] = percentile(0.50);
+    results["p99_us"] = percentile(0.99);
+
+    if(parser.isSet(saveOption))
+    {
+        QFile file(parser.value(saveOption));
+        if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            err << "Unable to write " << file.fileName() << "\n";
+            return Failure;
+        }
+        file.write(QJsonDocument(results).toJson());
+    }
+
+    if(parser.isSet(baselineOption))
+    {
+        QFile file(parser.value(baselineOption));
+        if(!file.open(QIODevice::ReadOnly))
+        {
+            err << "Unable to read " << file.fileName() << "\n";
+            return Failure;
+        }
+
+        auto baseline = QJsonDocument::fromJson(file.readAll()).object()["throughput"].toDouble();
+        auto threshold = qBound(0.0, parser.value(thresholdOption).toDouble(), 100.0);
+        auto floor = baseline * (100.0 - threshold) / 100.0;
+
+        auto change = baseline > 0.0 ? (throughput - baseline) * 100.0 / baseline : 0.0;
+        out << QString("baseline     %1 datagrams/s (%2%3%)\n")
+                .arg(baseline, 0, 'f', 0).arg(change >= 0.0 ? "+" : "").arg(change, 0, 'f', 1);
+
+        if(throughput < floor)
+        {
+            err << QString("REGRESSION: throughput fell more than %1% below the baseline\n").arg(threshold);
+            return Regression;
+        }
+    }
+
+    return Success;
+}
@@ -0,0 +1,37 @@
+QT = core network
+
+CONFIG += c++17 cmdline
+
+mac {
+    DEFINES += QT_OSX
+}
+
+unix:!mac {
+    DEFINES += QT_LINUX
+}
+
+win32 {
+    DEFINES += QT_WIN
+}
+
+# Codec compresses datagrams with zlib: the system's on Unix, and on
+# Windows the copy built into QtCore
+unix: LIBS += -lz
+win32: QT += zlib-private
+
+INCLUDEPATH += ../../common ../../common/network ../../model
+
+LIBS += -L$$OUT_PWD/../../model -ldashd-model
+win32: PRE_TARGETDEPS += $$OUT_PWD/../../model/dashd-model.lib
+else: PRE_TARGETDEPS += $$OUT_PWD/../../model/libdashd-model.a
+
+SOURCES += \
+    ../../common/network/Capture.cpp \
+    ../../common/network/Codec.cpp \
+    ../../common/network/Sender.cpp \
+    main.cpp
+
+HEADERS += \
+    ../../common/network/Capture.h \
+    ../../common/network/Codec.h \
+    ../../common/network/Sender.h